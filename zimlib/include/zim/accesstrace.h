@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_ACCESSTRACE_H
+#define ZIM_ACCESSTRACE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <zim/zim.h>
+#include <zim/uuid.h>
+#include <zim/mutex.h>
+#include <zim/noncopyable.h>
+
+namespace zim
+{
+  enum TraceKind
+  {
+    traceDirent,       // lookup of a dirent in the dirent cache
+    traceCluster,      // lookup of a cluster in the cluster cache
+    traceClusterRead,  // a cluster was read and decompressed
+    traceOpen          // a zim file is traced under a new file number
+  };
+
+  /**
+     A record of an access trace.
+
+     For traceDirent records, which are no hit, bytes is the size of the
+     dirent and usecs the time to read it. For traceCluster records
+     memBytes is the memory size of the cluster, if found in the cache. For
+     traceClusterRead records bytes is the number of bytes read from the
+     file (0, when the cluster was found in the raw cluster cache or the
+     cluster directory), memBytes the memory size of the decompressed
+     cluster and usecs the time to read and decompress it. Only compressed
+     clusters are kept in the cluster cache.
+
+     A traceOpen record starts the records of a zim file with the number
+     file; the uuid of the zim file is stored in idx, bytes, memBytes and
+     usecs.
+   */
+  struct TraceRecord
+  {
+    uint64_t time;    // microseconds since the start of the trace
+    unsigned file;    // number of the zim file in the trace
+    size_type idx;    // dirent or cluster index
+    size_type bytes;
+    size_type memBytes;
+    size_type usecs;
+    TraceKind kind;
+    bool hit;
+    CompressionType compression;
+
+    enum { size = 28 };   // size of a record in the file
+
+    TraceRecord()
+      : time(0),
+        file(0),
+        idx(0),
+        bytes(0),
+        memBytes(0),
+        usecs(0),
+        kind(traceDirent),
+        hit(false),
+        compression(zimcompNone)
+      { }
+  };
+
+  /**
+     Records the accesses to the caches of a zim file.
+
+     The trace is a binary file starting with the magic "ZIMTRACE"
+     followed by records of 28 bytes: time (64 bit), idx, bytes, memBytes
+     and usecs (32 bit each), kind, hit, compression and file (8 bit
+     each), all little endian.
+
+     All zim files of a process are traced into the trace returned by
+     getInstance(), which is opened from the environment variable
+     ZIM_TRACE. Each file gets a number with addFile(), which is noted in
+     its records, so that the accesses of several files and of files
+     opened again are kept apart. The numbers are counted modulo 256.
+
+     The records are buffered and written in blocks. Recording is thread
+     safe. Callers should check enabled() before collecting the data for a
+     record, so that a disabled trace costs nothing.
+   */
+  class AccessTrace : private NonCopyable
+  {
+      std::ofstream out;
+      std::string filename;
+      std::vector<char> buffer;
+      uint64_t start;
+      volatile bool active;
+      unsigned files;
+      Mutex mutex;
+
+      void _record(unsigned file, TraceKind kind, size_type idx, bool hit,
+                   size_type bytes, size_type memBytes, size_type usecs,
+                   CompressionType compression);
+      void _flush();
+
+      static AccessTrace* createInstance();
+
+    public:
+      AccessTrace()
+        : start(0),
+          active(false),
+          files(0)
+        { }
+
+      ~AccessTrace()
+        { close(); }
+
+      /// starts a trace into the file; throws std::runtime_error on failure
+      void open(const std::string& filename);
+      /// writes the buffered records and closes the file
+      void close();
+
+      /// writes the buffered records
+      void flush();
+
+      bool enabled() const   { return active; }
+      const std::string& getFilename() const   { return filename; }
+
+      /// returns the number of the zim file with the uuid in the trace and
+      /// records a traceOpen record
+      unsigned addFile(const Uuid& uuid);
+
+      void record(unsigned file, TraceKind kind, size_type idx, bool hit,
+                  size_type bytes = 0, size_type memBytes = 0, size_type usecs = 0,
+                  CompressionType compression = zimcompNone);
+
+      /// Returns the trace of the process, which is opened from ZIM_TRACE on
+      /// first use. It is never destroyed, so that files destroyed at exit
+      /// may still record into it; it is flushed at exit and by files, when
+      /// they are destroyed.
+      static AccessTrace& getInstance();
+
+      /// returns the time of the monotonic clock in microseconds
+      static uint64_t now();
+  };
+
+  /// reads a trace written by AccessTrace
+  class TraceReader : private NonCopyable
+  {
+      std::ifstream in;
+
+    public:
+      /// opens the trace; throws std::runtime_error, if it is not readable
+      /// or not a trace
+      explicit TraceReader(const std::string& filename);
+
+      /// reads the next record and returns false at the end of the trace
+      bool next(TraceRecord& r);
+  };
+
+}
+
+#endif // ZIM_ACCESSTRACE_H
@@ -0,0 +1,379 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_ARCCACHE_H
+#define ZIM_ARCCACHE_H
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <zim/zim.h>
+#include <zim/noncopyable.h>
+#include <zim/cache.h>
+#include <zim/cachelist.h>
+
+namespace zim
+{
+  /**
+     Cache with the adaptive replacement algorithm (ARC).
+
+     The interface is the same as of Cache. The elements are kept in 2
+     lists: T1 holds the elements, which were found once after they were
+     put into the cache, T2 the elements, which were found more often.
+     Dropped elements are remembered without their value in the ghost lists
+     B1 and B2. A later put of a key found in B1 shows, that T1 was too
+     small, so the target size of T1 grows, and a put of a key found in B2
+     lets it shrink. The cache therefore adapts itself between recency and
+     frequency and is resistant against scans.
+
+     When a maximum cost is set, the sizes of the lists and the target size
+     are measured in costs, otherwise in number of elements. The ghost
+     lists take at most as much as the cache itself and no more elements
+     than the maximum number of elements.
+   */
+  template <typename Key, typename Value, typename Hash = CacheHash<Key> >
+  class ArcCache : private NonCopyable
+  {
+    public:
+      typedef std::size_t size_type;
+      typedef Value value_type;
+
+    private:
+      enum ListId { listT1, listT2, listB1, listB2 };
+
+      struct Node
+      {
+        Key key;
+        Value value;
+        size_type cost;
+        ListId list;
+        Node* hashNext;
+        Node* prev;   // newer element
+        Node* next;   // older element
+
+        Node(const Key& key_, const Value& value_, size_type cost_, ListId list_)
+          : key(key_),
+            value(value_),
+            cost(cost_),
+            list(list_),
+            hashNext(0),
+            prev(0),
+            next(0)
+            { }
+
+        bool resident() const   { return list == listT1 || list == listT2; }
+      };
+
+      typedef CacheList<Node> List;
+
+      CacheTable<Node, Key, Hash> table;
+      List lists[4];
+
+      size_type maxElements;
+      size_type maxCost;
+      size_type peakCost;
+      size_type target;   // target size of T1
+      uint64_t hits;
+      uint64_t misses;
+      uint64_t evictions;
+
+      size_type _capacity() const
+        { return maxCost > 0 ? maxCost : maxElements; }
+
+      size_type _size(ListId l) const
+        { return maxCost > 0 ? lists[l].cost : lists[l].count; }
+
+      size_type _size(const Node* n) const
+        { return maxCost > 0 ? n->cost : 1; }
+
+      bool _overflow() const
+        { return size() > maxElements || (maxCost > 0 && getCost() > maxCost); }
+
+      bool _noRoom(size_type cost) const
+        { return size() > 0 && (size() >= maxElements || (maxCost > 0 && getCost() + cost > maxCost)); }
+
+      void _move(Node* n, ListId l)
+      {
+        lists[n->list].unlink(n);
+        n->list = l;
+        lists[l].pushNewest(n);
+      }
+
+      void _remove(Node* n)
+      {
+        table.remove(n);
+        lists[n->list].unlink(n);
+        delete n;
+      }
+
+      // moves the oldest element of T1 or T2 to the ghost lists
+      void _replace(bool ghostOfB2)
+      {
+        Node* n;
+        if (lists[listT1].count > 0
+          && (_size(listT1) > target
+            || (ghostOfB2 && _size(listT1) == target)
+            || lists[listT2].count == 0))
+        {
+          n = lists[listT1].oldest;
+          _move(n, listB1);
+        }
+        else
+        {
+          n = lists[listT2].oldest;
+          _move(n, listB2);
+        }
+
+        n->value = Value();
+        ++evictions;
+      }
+
+      // limits the size of the ghost lists
+      void _trimGhosts()
+      {
+        size_type c = _capacity();
+
+        while (lists[listB1].count > 0 && _size(listT1) + _size(listB1) > c)
+          _remove(lists[listB1].oldest);
+
+        while (lists[listB2].count > 0
+          && _size(listT1) + _size(listT2) + _size(listB1) + _size(listB2) > 2 * c)
+          _remove(lists[listB2].oldest);
+
+        while (lists[listB1].count + lists[listB2].count > maxElements)
+          _remove(lists[lists[listB2].count > 0 ? listB2 : listB1].oldest);
+      }
+
+      void _shrink()
+      {
+        while (_overflow())
+          _replace(false);
+        _trimGhosts();
+
+        if (target > _capacity())
+          target = _capacity();
+      }
+
+      void _put(const Key& key, const Value& value, size_type cost, bool top)
+      {
+        if (maxElements == 0 || (maxCost > 0 && cost > maxCost))
+        {
+          // the element does not fit into the cache at all
+          erase(key);
+          return;
+        }
+
+        Node* n = table.find(key);
+        if (n && n->resident())
+        {
+          List& l = lists[n->list];
+          l.cost -= n->cost;
+          n->value = value;
+          n->cost = cost;
+          l.cost += n->cost;
+          _move(n, listT2);
+
+          while (_overflow())
+            _replace(false);
+        }
+        else if (n)
+        {
+          // a ghost was hit, so adapt the target size of T1
+          bool ghostOfB2 = n->list == listB2;
+          lists[n->list].unlink(n);
+          n->cost = cost;
+
+          size_type b1 = _size(listB1);
+          size_type b2 = _size(listB2);
+          if (ghostOfB2)
+          {
+            size_type delta = (b2 > 0 && b1 > b2 ? b1 / b2 : 1) * _size(n);
+            target = target > delta ? target - delta : 0;
+          }
+          else
+          {
+            size_type delta = (b1 > 0 && b2 > b1 ? b2 / b1 : 1) * _size(n);
+            target = target + delta < _capacity() ? target + delta : _capacity();
+          }
+
+          while (_noRoom(cost))
+            _replace(ghostOfB2);
+
+          n->value = value;
+          n->list = listT2;
+          lists[listT2].pushNewest(n);
+        }
+        else
+        {
+          while (_noRoom(cost))
+            _replace(false);
+
+          n = new Node(key, value, cost, top ? listT2 : listT1);
+          table.insert(n);
+          lists[n->list].pushNewest(n);
+        }
+
+        _trimGhosts();
+
+        if (getCost() > peakCost)
+          peakCost = getCost();
+      }
+
+    public:
+      explicit ArcCache(size_type maxElements_, size_type maxCost_ = 0)
+        : maxElements(maxElements_),
+          maxCost(maxCost_),
+          peakCost(0),
+          target(0),
+          hits(0),
+          misses(0),
+          evictions(0)
+        { }
+
+      ~ArcCache()
+        { clear(); }
+
+      /// returns the number of elements currently in the cache
+      size_type size() const        { return lists[listT1].count + lists[listT2].count; }
+
+      /// returns the maximum number of elements in the cache
+      size_type getMaxElements() const      { return maxElements; }
+
+      void setMaxElements(size_type maxElements_)
+      {
+        maxElements = maxElements_;
+        _shrink();
+      }
+
+      /// returns the sum of the costs of the elements in the cache
+      size_type getCost() const     { return lists[listT1].cost + lists[listT2].cost; }
+
+      /// returns the highest cost held in the cache since the last reset of
+      /// the statistics
+      size_type getPeakCost() const { return peakCost; }
+
+      /// returns the maximum cost of the cache or 0 if not limited
+      size_type getMaxCost() const  { return maxCost; }
+
+      void setMaxCost(size_type maxCost_)
+      {
+        maxCost = maxCost_;
+        _shrink();
+      }
+
+      /// returns the estimated number of bytes used for managing the
+      /// elements, i.e. the hash table and the list nodes including the
+      /// ghosts
+      size_type getOverhead() const
+        { return table.bucketCount() * sizeof(Node*) + table.size() * sizeof(Node); }
+
+      /// removes a element from the cache and returns true, if found
+      bool erase(const Key& key)
+      {
+        Node* n = table.find(key);
+        if (n == 0)
+          return false;
+
+        bool resident = n->resident();
+        _remove(n);
+        return resident;
+      }
+
+      /// clears the cache including the ghosts.
+      void clear(bool stats = false)
+      {
+        table.clear();
+        for (unsigned l = 0; l < 4; ++l)
+          lists[l] = List();
+        target = 0;
+
+        if (stats)
+          hits = misses = evictions = peakCost = 0;
+      }
+
+      /// puts a new element into the cache. If the element is already found
+      /// in the cache, its value is replaced and it is moved to T2.
+      void put(const Key& key, const Value& value, size_type cost = 1)
+        { _put(key, value, cost, false); }
+
+      /// puts a new element directly into T2 like an element, which was
+      /// found before.
+      void put_top(const Key& key, const Value& value, size_type cost = 1)
+        { _put(key, value, cost, true); }
+
+      /// returns true, if the key is found; this is neither counted as a hit
+      /// or miss nor does it change the order of the elements
+      bool contains(const Key& key)
+      {
+        Node* n = table.find(key);
+        return n != 0 && n->resident();
+      }
+
+      Value* getptr(const Key& key)
+      {
+        Node* n = table.find(key);
+        if (n == 0 || !n->resident())
+        {
+          ++misses;
+          return 0;
+        }
+
+        ++hits;
+        _move(n, listT2);
+        return &n->value;
+      }
+
+      /// returns a pair of values - a flag, if the value was found and the
+      /// value if found or the passed default otherwise.
+      std::pair<bool, Value> getx(const Key& key, Value def = Value())
+      {
+        Value* v = getptr(key);
+        return v ? std::pair<bool, Value>(true, *v)
+                 : std::pair<bool, Value>(false, def);
+      }
+
+      /// returns the value to a key or the passed default value if not found.
+      Value get(const Key& key, Value def = Value())
+      {
+        return getx(key, def).second;
+      }
+
+      /// returns the number of hits.
+      uint64_t getHits() const    { return hits; }
+      /// returns the number of misses.
+      uint64_t getMisses() const  { return misses; }
+      /// returns the number of elements dropped, because the cache was full.
+      uint64_t getEvictions() const { return evictions; }
+      /// returns the cache hit ratio between 0 and 1.
+      double hitRatio() const     { return hits+misses > 0 ? static_cast<double>(hits)/static_cast<double>(hits+misses) : 0; }
+      /// returns the ratio, between held elements and maximum elements or
+      /// the ratio between the cost and the maximum cost, if set.
+      double fillfactor() const
+      {
+        return maxCost > 0     ? static_cast<double>(getCost()) / static_cast<double>(maxCost)
+             : maxElements > 0 ? static_cast<double>(size()) / static_cast<double>(maxElements)
+             : 0;
+      }
+
+  };
+
+}
+
+#endif // ZIM_ARCCACHE_H
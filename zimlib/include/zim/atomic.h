@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_ATOMIC_H
+#define ZIM_ATOMIC_H
+
+#if !defined(__GNUC__)
+#include <zim/mutex.h>
+#endif
+
+namespace zim
+{
+  /**
+     Atomic operations on integral values.
+
+     gcc (and compatible compilers) provide builtins for that. On other
+     compilers a global mutex is used.
+   */
+#if defined(__GNUC__)
+
+  template <typename T>
+  inline T atomicAdd(volatile T& value, T n)
+    { return __sync_add_and_fetch(&value, n); }
+
+  template <typename T>
+  inline T atomicSub(volatile T& value, T n)
+    { return __sync_sub_and_fetch(&value, n); }
+
+  template <typename T>
+  inline T atomicGet(volatile T& value)
+    { return __sync_add_and_fetch(&value, 0); }
+
+  template <typename T>
+  inline bool atomicCompareExchange(volatile T& value, T oldValue, T newValue)
+    { return __sync_bool_compare_and_swap(&value, oldValue, newValue); }
+
+#else
+
+  inline Mutex& atomicMutex()
+  {
+    static Mutex mutex;
+    return mutex;
+  }
+
+  template <typename T>
+  inline T atomicAdd(volatile T& value, T n)
+    { MutexLock lock(atomicMutex()); return value += n; }
+
+  template <typename T>
+  inline T atomicSub(volatile T& value, T n)
+    { MutexLock lock(atomicMutex()); return value -= n; }
+
+  template <typename T>
+  inline T atomicGet(volatile T& value)
+    { MutexLock lock(atomicMutex()); return value; }
+
+  template <typename T>
+  inline bool atomicCompareExchange(volatile T& value, T oldValue, T newValue)
+  {
+    MutexLock lock(atomicMutex());
+    if (value != oldValue)
+      return false;
+    value = newValue;
+    return true;
+  }
+
+#endif
+
+  template <typename T>
+  inline T atomicIncrement(volatile T& value)
+    { return atomicAdd(value, static_cast<T>(1)); }
+
+  template <typename T>
+  inline T atomicDecrement(volatile T& value)
+    { return atomicSub(value, static_cast<T>(1)); }
+
+  template <typename T>
+  inline void atomicSet(volatile T& value, T newValue)
+  {
+    T oldValue;
+    do
+      oldValue = value;
+    while (!atomicCompareExchange(value, oldValue, newValue));
+  }
+
+}
+
+#endif // ZIM_ATOMIC_H
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_BUFFERPOOL_H
+#define ZIM_BUFFERPOOL_H
+
+#include <map>
+#include <vector>
+#include <cstddef>
+#include <zim/mutex.h>
+#include <zim/noncopyable.h>
+
+namespace zim
+{
+  /**
+     Pool of buffers for cluster data.
+
+     Released buffers are kept in free lists by size and handed out again,
+     so that the memory of evicted clusters is reused instead of being
+     returned to the system and faulted in again. The sizes are rounded up
+     to classes with 4 steps per power of 2, so that at most 25% is wasted.
+
+     The number of bytes kept in the free lists is limited by the
+     environment variable ZIM_BUFFERPOOL (default 8M); 0 disables the
+     pool. The pool is shared by all files of the process and comes on top
+     of the byte limits of their cluster caches. When ZIM_HUGEPAGES is set to 1, buffers of 2M or more are
+     aligned to 2M and marked for transparent huge pages, where supported.
+   */
+  class BufferPool : private NonCopyable
+  {
+      typedef std::vector<char*> FreeList;
+      typedef std::map<std::size_t, FreeList> FreeLists;
+
+      Mutex mutex;
+      FreeLists freeLists;
+      std::size_t pooledBytes;
+      std::size_t maxPooledBytes;
+      bool hugePages;
+
+      BufferPool();
+
+      std::size_t classSize(std::size_t size) const;
+      char* allocSystem(std::size_t size);
+
+    public:
+      static BufferPool& getInstance();
+
+      /// Returns a uninitialized buffer of at least size bytes. The size is
+      /// set to the actual size of the buffer.
+      char* allocate(std::size_t& size);
+
+      /// Returns a buffer, which was allocated with the passed size.
+      void release(char* p, std::size_t size);
+
+      /// Frees all buffers in the free lists.
+      void purge();
+
+      /// returns the number of bytes in the free lists
+      std::size_t getPooledBytes();
+  };
+
+  /**
+     A growing buffer allocated from the BufferPool. Unlike with
+     std::vector, new bytes are not initialized.
+   */
+  class Buffer : private NonCopyable
+  {
+      char* ptr;
+      std::size_t bufsize;
+      std::size_t bufcapacity;
+
+    public:
+      Buffer()
+        : ptr(0),
+          bufsize(0),
+          bufcapacity(0)
+        { }
+
+      ~Buffer()
+        { clear(); }
+
+      char* data()                          { return ptr; }
+      const char* data() const              { return ptr; }
+      std::size_t size() const              { return bufsize; }
+      std::size_t capacity() const          { return bufcapacity; }
+      bool empty() const                    { return bufsize == 0; }
+
+      char& operator[] (std::size_t n)             { return ptr[n]; }
+      const char& operator[] (std::size_t n) const { return ptr[n]; }
+
+      /// makes room for at least n bytes; the content is kept
+      void reserve(std::size_t n);
+      /// changes the size to n; new bytes are not initialized
+      void resize(std::size_t n)
+      {
+        if (n > bufcapacity)
+          reserve(n);
+        bufsize = n;
+      }
+      void assign(const char* begin, const char* end);
+      /// returns the memory to the pool
+      void clear();
+  };
+
+}
+
+#endif // ZIM_BUFFERPOOL_H
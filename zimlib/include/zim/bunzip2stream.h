@@ -23,8 +23,10 @@
 
 #include <iostream>
 #include <stdexcept>
+#include <cstddef>
 #include <bzlib.h>
 #include <zim/bzip2.h>
+#include <zim/bufferpool.h>
 
 namespace zim
 {
@@ -38,7 +40,12 @@ namespace zim
 
   class Bunzip2StreamBuf : public std::streambuf
   {
-      bz_stream stream;
+    public:
+      struct Decoder;   // pooled decoder state and buffer
+
+    private:
+      Decoder* decoder;
+      bz_stream& stream;
       char_type* iobuffer;
       unsigned bufsize;
       std::streambuf* sinksource;
@@ -81,6 +88,11 @@ namespace zim
       void setSink(std::ostream& sink)                 { streambuf.setSinksource(sink.rdbuf()); }
       void setSource(std::istream& source)             { streambuf.setSinksource(source.rdbuf()); }
   };
+
+  /// Decompresses the bzip2 stream in [data, data+size) into out, which is
+  /// resized to the uncompressed size. When the uncompressed size is known,
+  /// it is passed as sizeHint, so that out is allocated just once.
+  void bunzip2Buffer(const char* data, std::size_t size, Buffer& out, std::size_t sizeHint = 0);
 }
 
 #endif // ZIM_BUNZIP2STREAM_H
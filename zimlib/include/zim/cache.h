@@ -20,19 +20,49 @@
 #ifndef ZIM_CACHE_H
 #define ZIM_CACHE_H
 
-#include <map>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
 #include <limits>
-#include <iostream>
-
-#ifdef _WIN32
-#define NOMINMAX
-#include <windows.h>
-#undef NOMINMAX
-#undef max
-#endif
+#include <zim/zim.h>
+#include <zim/noncopyable.h>
+#include <zim/cachelist.h>
 
 namespace zim
 {
+  /// hash function for integral cache keys
+  inline std::size_t cacheHash(uint64_t v)
+  {
+    // finalizer of MurmurHash3; spreads the bits, so that the low bits may
+    // be used as bucket index and the high bits as shard index
+    v ^= v >> 33;
+    v *= (static_cast<uint64_t>(0xff51afd7) << 32) | 0xed558ccd;
+    v ^= v >> 33;
+    v *= (static_cast<uint64_t>(0xc4ceb9fe) << 32) | 0x1a85ec53;
+    v ^= v >> 33;
+    return static_cast<std::size_t>(v);
+  }
+
+  /// hash function for string cache keys (FNV-1a)
+  inline std::size_t cacheHash(const std::string& s)
+  {
+    uint64_t h = (static_cast<uint64_t>(0xcbf29ce4) << 32) | 0x84222325;
+    for (std::string::const_iterator it = s.begin(); it != s.end(); ++it)
+    {
+      h ^= static_cast<unsigned char>(*it);
+      h *= (static_cast<uint64_t>(0x100) << 32) | 0x000001b3;
+    }
+    return cacheHash(h);
+  }
+
+  template <typename Key>
+  struct CacheHash
+  {
+    std::size_t operator() (const Key& key) const
+      { return cacheHash(key); }
+  };
+
   /**
      Implements a container for caching elements.
 
@@ -52,259 +82,304 @@ namespace zim
        - when getting a value and the value is found, it is put to the
          beginning of the list
 
-     When elements are searched, a linear search is done using the ==-operator
-     of the key type.
-
      The caching algorithm keeps elements, which are fetched more than once in
-     the first half of the list. In the second half the elements are either new
-     or the elements are pushed from the first half to the second half by other
-     elements, which are found in the cache.
+     the first half of the list (the winners). In the second half (the
+     loosers) the elements are either new or the elements are pushed from the
+     first half to the second half by other elements, which are found in the
+     cache.
+
+     Optionally each element has a cost (e.g. its size in bytes), which is
+     passed to put. When a maximum cost is set, the size of the cache is
+     limited by the sum of the costs of the elements in addition to the
+     number of elements and the winners may take half of the maximum cost.
 
-     You should be aware, that the key type should be simple. Comparing keys
-     must be cheap. Copying elements (both key and value) must be possible and
-     should be cheap, since they are moved in the underlying container.
+     Elements are found using a hash table and both halfs are kept in doubly
+     linked lists ordered by last access, so that all operations take
+     constant time. The hash function is given by the template parameter
+     Hash, which defaults to cacheHash(key). Keys are compared using the
+     ==-operator.
+
+     The cache is not thread safe. See ConcurrentCache for a cache, which can
+     be used by multiple threads.
 
    */
-  template <typename Key, typename Value>
-  class Cache
+  template <typename Key, typename Value, typename Hash = CacheHash<Key> >
+  class Cache : private NonCopyable
   {
-      struct Data
+    public:
+      typedef std::size_t size_type;
+      typedef Value value_type;
+
+    private:
+      struct Node
       {
-        bool winner;
-        unsigned serial;
+        Key key;
         Value value;
-        Data() { }
-        Data(bool winner_, unsigned serial_, const Value& value_)
-          : winner(winner_),
-            serial(serial_),
-            value(value_)
+        size_type cost;
+        bool winner;
+        Node* hashNext;
+        Node* prev;   // newer element
+        Node* next;   // older element
+
+        Node(const Key& key_, const Value& value_, size_type cost_, bool winner_)
+          : key(key_),
+            value(value_),
+            cost(cost_),
+            winner(winner_),
+            hashNext(0),
+            prev(0),
+            next(0)
             { }
       };
 
-      typedef std::map<Key, Data> DataType;
-      DataType data;
+      typedef CacheList<Node> List;
 
-      typename DataType::size_type maxElements;
-      unsigned serial;
-      unsigned hits;
-      unsigned misses;
+      CacheTable<Node, Key, Hash> table;
+      List winners;
+      List loosers;
 
-      unsigned _nextSerial()
-      {
-        if (serial == std::numeric_limits<unsigned>::max())
-        {
-          for (typename DataType::iterator it = data.begin(); it != data.end(); ++it)
-            it->second.serial = 0;
-          serial = 1;
-        }
+      size_type maxElements;
+      size_type maxCost;
+      size_type peakCost;
+      uint64_t hits;
+      uint64_t misses;
+      uint64_t evictions;
 
-        return serial++;
-      }
+      Node* _find(const Key& key) const
+        { return table.find(key); }
 
-      typename DataType::iterator _getOldest(bool winner)
+      void _remove(Node* n)
       {
-        typename DataType::iterator foundElement = data.begin();
-
-        typename DataType::iterator it = data.begin();
+        table.remove(n);
+        (n->winner ? winners : loosers).unlink(n);
+        delete n;
+      }
 
-        for (++it; it != data.end(); ++it)
-          if (it->second.winner == winner
-            && (foundElement->second.winner != winner || it->second.serial < foundElement->second.serial))
-              foundElement = it;
+      void _insert(const Key& key, const Value& value, size_type cost, bool winner)
+      {
+        Node* n = new Node(key, value, cost, winner);
+        table.insert(n);
+        (winner ? winners : loosers).pushNewest(n);
 
-        return foundElement;
+        if (getCost() > peakCost)
+          peakCost = getCost();
       }
 
-      typename DataType::iterator _getNewest(bool winner)
-      {
-        typename DataType::iterator foundElement = data.begin();
+      // The winners and the loosers get half of the elements each, so the
+      // maximum is rounded up to an even number. The largest value is
+      // rounded down instead, so that an unlimited count does not wrap to 0.
+      static size_type _evenElements(size_type n)
+        { return n < std::numeric_limits<size_type>::max() ? n + (n & 1) : n - 1; }
 
-        typename DataType::iterator it = data.begin();
+      bool _overflow() const
+        { return size() > maxElements || (maxCost > 0 && getCost() > maxCost); }
 
-        for (++it; it != data.end(); ++it)
-          if (it->second.winner == winner
-            && (foundElement->second.winner != winner || it->second.serial > foundElement->second.serial))
-              foundElement = it;
+      bool _tooManyWinners() const
+        { return winners.count > 1
+              && (winners.count > maxElements / 2 || (maxCost > 0 && winners.cost > maxCost / 2)); }
 
-        return foundElement;
-      }
+      bool _winnerFits(size_type cost) const
+        { return winners.count < maxElements / 2 && (maxCost == 0 || winners.cost + cost <= maxCost / 2); }
 
       // drop one element
       void _dropLooser()
       {
-        // look for the oldest element in the list of loosers to drop it
-        data.erase(_getOldest(false));
+        // drop the oldest element in the list of loosers
+        if (loosers.oldest == 0)
+          _makeLooser();
+        _remove(loosers.oldest);
+        ++evictions;
       }
 
       void _makeLooser()
       {
-        // look for the oldest element in the list of winners to make it a looser
-        typename DataType::iterator it = _getOldest(true);
-        it->second.winner = false;
-        it->second.serial = _nextSerial();
+        // the oldest element in the list of winners becomes the newest looser
+        Node* n = winners.oldest;
+        winners.unlink(n);
+        n->winner = false;
+        loosers.pushNewest(n);
       }
 
-    public:
-      typedef typename DataType::size_type size_type;
-      typedef Value value_type;
+      // the newest looser becomes the oldest winner
+      void _promoteLooser()
+      {
+        Node* n = loosers.newest;
+        loosers.unlink(n);
+        n->winner = true;
+        winners.pushOldest(n);
+      }
+
+      // moves the element to the top of the list
+      void _touch(Node* n)
+      {
+        if (n->winner)
+        {
+          winners.unlink(n);
+          winners.pushNewest(n);
+        }
+        else
+        {
+          // move element to the winner part
+          loosers.unlink(n);
+          n->winner = true;
+          winners.pushNewest(n);
+        }
 
-      explicit Cache(size_type maxElements_)
-        : maxElements(maxElements_ + (maxElements_ & 1)),
-          serial(0),
+        while (_tooManyWinners())
+          _makeLooser();
+      }
+
+      void _put(const Key& key, const Value& value, size_type cost, bool top)
+      {
+        if (maxElements == 0 || (maxCost > 0 && cost > maxCost))
+        {
+          // the element does not fit into the cache at all
+          erase(key);
+          return;
+        }
+
+        Node* n = _find(key);
+        if (n)
+        {
+          // element found
+          (n->winner ? winners : loosers).cost -= n->cost;
+          n->value = value;
+          n->cost = cost;
+          (n->winner ? winners : loosers).cost += n->cost;
+          if (getCost() > peakCost)
+            peakCost = getCost();
+          _touch(n);
+        }
+        else
+        {
+          // element not found
+          _insert(key, value, cost, top || _winnerFits(cost));
+          while (_tooManyWinners())
+            _makeLooser();
+        }
+
+        while (_overflow())
+          _dropLooser();
+      }
+
+    public:
+      explicit Cache(size_type maxElements_, size_type maxCost_ = 0)
+        : maxElements(_evenElements(maxElements_)),
+          maxCost(maxCost_),
+          peakCost(0),
           hits(0),
-          misses(0)
+          misses(0),
+          evictions(0)
         { }
 
+      ~Cache()
+        { clear(); }
+
       /// returns the number of elements currently in the cache
-      size_type size() const        { return data.size(); }
+      size_type size() const        { return winners.count + loosers.count; }
 
       /// returns the maximum number of elements in the cache
       size_type getMaxElements() const      { return maxElements; }
 
       void setMaxElements(size_type maxElements_)
       {
-        size_type numWinners = size() < maxElements / 2 ? size() : maxElements / 2;
+        maxElements = _evenElements(maxElements_);
+        _shrink();
+      }
 
-        maxElements_ += (maxElements_ & 1);
+      /// returns the sum of the costs of the elements in the cache
+      size_type getCost() const     { return winners.cost + loosers.cost; }
 
-        if (maxElements_ > maxElements)
-        {
-          maxElements = maxElements_;
+      /// returns the highest cost held in the cache since the last reset of
+      /// the statistics
+      size_type getPeakCost() const { return peakCost; }
 
-          while (numWinners < maxElements / 2)
-          {
-            _getNewest(false)->winner = true;
-            ++numWinners;
-          }
-        }
-        else
-        {
-          while (maxElements > maxElements_)
-          {
-            _dropLooser();
-            _dropLooser();
-            _makeLooser();
-            maxElements -= 2;
-          }
-
-          while (numWinners > maxElements / 2)
-          {
-            _getNewest(true)->winner = false;
-            --numWinners;
-          }
-        }
+      /// returns the maximum cost of the cache or 0 if not limited
+      size_type getMaxCost() const  { return maxCost; }
+
+      void setMaxCost(size_type maxCost_)
+      {
+        maxCost = maxCost_;
+        _shrink();
+      }
+
+      /// returns the estimated number of bytes used for managing the
+      /// elements, i.e. the hash table and the list nodes
+      size_type getOverhead() const
+        { return table.bucketCount() * sizeof(Node*) + size() * sizeof(Node); }
+
+    private:
+      void _shrink()
+      {
+        while (size() > 0 && _overflow())
+          _dropLooser();
+
+        while (_tooManyWinners())
+          _makeLooser();
 
+        // fill up the winners with the newest loosers
+        while (loosers.newest && _winnerFits(loosers.newest->cost))
+          _promoteLooser();
       }
 
+    public:
       /// removes a element from the cache and returns true, if found
       bool erase(const Key& key)
       {
-        typename DataType::iterator it = data.find(key);
-        if (it == data.end())
+        Node* n = _find(key);
+        if (n == 0)
           return false;
 
-        if (it->second.winner)
-          _getNewest(false)->winner=true;
+        bool winner = n->winner;
+        _remove(n);
+
+        if (winner && loosers.newest && _winnerFits(loosers.newest->cost))
+          _promoteLooser();
 
-        data.erase(it);
         return true;
       }
 
       /// clears the cache.
       void clear(bool stats = false)
       {
-        data.clear();
+        table.clear();
+        winners = List();
+        loosers = List();
+
         if (stats)
-          hits = misses = 0;
+          hits = misses = evictions = peakCost = 0;
       }
 
       /// puts a new element in the cache. If the element is already found in
-      /// the cache, it is considered a cache hit and pushed to the top of the
-      /// list.
-      void put(const Key& key, const Value& value)
-      {
-        typename DataType::iterator it;
-        if (data.size() < maxElements)
-        {
-          data.insert(data.begin(),
-            typename DataType::value_type(key,
-              Data(data.size() < maxElements / 2, _nextSerial(), value)));
-        }
-        else if ((it = data.find(key)) == data.end())
-        {
-          // element not found
-          _dropLooser();
-          data.insert(data.begin(),
-            typename DataType::value_type(key,
-              Data(false, _nextSerial(), value)));
-        }
-        else
-        {
-          // element found
-          it->second.serial = _nextSerial();
-          if (!it->second.winner)
-          {
-            // move element to the winner part
-            it->second.winner = true;
-            _makeLooser();
-          }
-        }
-      }
+      /// the cache, its value is replaced. This is considered a cache hit and
+      /// the element is pushed to the top of the list.
+      void put(const Key& key, const Value& value, size_type cost = 1)
+        { _put(key, value, cost, false); }
 
       /// puts a new element on the top of the cache. If the element is already
       /// found in the cache, it is considered a cache hit and pushed to the
       /// top of the list. This method actually overrides the need, that a element
       /// needs a hit to get to the top of the cache.
-      void put_top(const Key& key, const Value& value)
-      {
-        typename DataType::iterator it;
-        if (data.size() < maxElements)
-        {
-          if (data.size() >= maxElements / 2)
-            _makeLooser();
+      void put_top(const Key& key, const Value& value, size_type cost = 1)
+        { _put(key, value, cost, true); }
 
-          data.insert(data.begin(),
-            typename DataType::value_type(key,
-              Data(true, _nextSerial(), value)));
-        }
-        else if ((it = data.find(key)) == data.end())
-        {
-          // element not found
-          _dropLooser();
-          _makeLooser();
-          data.insert(data.begin(),
-            typename DataType::value_type(key,
-              Data(true, _nextSerial(), value)));
-        }
-        else
-        {
-          // element found
-          it->second.serial = _nextSerial();
-          if (!it->second.winner)
-          {
-            // move element to the winner part
-            it->second.winner = true;
-            _makeLooser();
-          }
-        }
-      }
+      /// returns true, if the key is found; this is neither counted as a hit
+      /// or miss nor does it change the order of the elements
+      bool contains(const Key& key)
+        { return _find(key) != 0; }
 
       Value* getptr(const Key& key)
       {
-        typename DataType::iterator it = data.find(key);
-        if (it == data.end())
-          return 0;
-
-        it->second.serial = _nextSerial();
-
-        if (!it->second.winner)
+        Node* n = _find(key);
+        if (n == 0)
         {
-          // move element to the winner part
-          it->second.winner = true;
-          _makeLooser();
+          ++misses;
+          return 0;
         }
 
-        return &it->second.value;
+        ++hits;
+        _touch(n);
+        return &n->value;
       }
 
       /// returns a pair of values - a flag, if the value was found and the
@@ -326,25 +401,21 @@ namespace zim
       }
 
       /// returns the number of hits.
-      unsigned getHits() const    { return hits; }
+      uint64_t getHits() const    { return hits; }
       /// returns the number of misses.
-      unsigned getMisses() const  { return misses; }
+      uint64_t getMisses() const  { return misses; }
+      /// returns the number of elements dropped, because the cache was full.
+      uint64_t getEvictions() const { return evictions; }
       /// returns the cache hit ratio between 0 and 1.
       double hitRatio() const     { return hits+misses > 0 ? static_cast<double>(hits)/static_cast<double>(hits+misses) : 0; }
-      /// returns the ratio, between held elements and maximum elements.
-      double fillfactor() const   { return static_cast<double>(data.size()) / static_cast<double>(maxElements); }
-
-/*
-      void dump(std::ostream& out) const
+      /// returns the ratio, between held elements and maximum elements or
+      /// the ratio between the cost and the maximum cost, if set.
+      double fillfactor() const
       {
-        out << "cache max size=" << maxElements << " current size=" << size() << '\n';
-        for (typename DataType::const_iterator it = data.begin(); it != data.end(); ++it)
-        {
-          out << "\tkey=\"" << it->first << "\" value=\"" << it->second.value << "\" serial=" << it->second.serial << " winner=" << it->second.winner << '\n';
-        }
-        out << "--------\n";
+        return maxCost > 0     ? static_cast<double>(getCost()) / static_cast<double>(maxCost)
+             : maxElements > 0 ? static_cast<double>(size()) / static_cast<double>(maxElements)
+             : 0;
       }
-*/
 
   };
 
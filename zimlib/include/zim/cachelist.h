@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_CACHELIST_H
+#define ZIM_CACHELIST_H
+
+#include <vector>
+#include <cstddef>
+#include <zim/noncopyable.h>
+
+namespace zim
+{
+  /**
+     Doubly linked list of cache nodes ordered by last access.
+
+     The list does not own the nodes. Node needs the members prev (the newer
+     node), next (the older node) and cost. The list keeps the number and the
+     sum of the costs of its nodes.
+   */
+  template <typename Node>
+  struct CacheList
+  {
+    Node* newest;
+    Node* oldest;
+    std::size_t count;
+    std::size_t cost;
+
+    CacheList()
+      : newest(0),
+        oldest(0),
+        count(0),
+        cost(0)
+        { }
+
+    void pushNewest(Node* n)
+    {
+      n->prev = 0;
+      n->next = newest;
+      if (newest)
+        newest->prev = n;
+      else
+        oldest = n;
+      newest = n;
+      ++count;
+      cost += n->cost;
+    }
+
+    void pushOldest(Node* n)
+    {
+      n->next = 0;
+      n->prev = oldest;
+      if (oldest)
+        oldest->next = n;
+      else
+        newest = n;
+      oldest = n;
+      ++count;
+      cost += n->cost;
+    }
+
+    void unlink(Node* n)
+    {
+      if (n->prev)
+        n->prev->next = n->next;
+      else
+        newest = n->next;
+
+      if (n->next)
+        n->next->prev = n->prev;
+      else
+        oldest = n->prev;
+
+      --count;
+      cost -= n->cost;
+    }
+  };
+
+  /**
+     Hash table of cache nodes with chaining.
+
+     The table owns the nodes and deletes them in clear. Node needs the
+     members key and hashNext. The number of buckets is a power of 2 and
+     grows with the number of nodes.
+   */
+  template <typename Node, typename Key, typename Hash>
+  class CacheTable : private NonCopyable
+  {
+      std::vector<Node*> buckets;
+      std::size_t count;
+      Hash hash;
+
+      Node** _bucket(const Key& key)
+        { return &buckets[hash(key) & (buckets.size() - 1)]; }
+
+      void _rehash(std::size_t s)
+      {
+        std::vector<Node*> b(s, static_cast<Node*>(0));
+        buckets.swap(b);
+        for (typename std::vector<Node*>::iterator it = b.begin(); it != b.end(); ++it)
+        {
+          Node* n = *it;
+          while (n)
+          {
+            Node* next = n->hashNext;
+            Node** p = _bucket(n->key);
+            n->hashNext = *p;
+            *p = n;
+            n = next;
+          }
+        }
+      }
+
+    public:
+      CacheTable()
+        : buckets(8, static_cast<Node*>(0)),
+          count(0)
+        { }
+
+      ~CacheTable()
+        { clear(); }
+
+      /// returns the number of nodes in the table
+      std::size_t size() const          { return count; }
+
+      /// returns the number of buckets
+      std::size_t bucketCount() const   { return buckets.size(); }
+
+      /// returns the hash of the key
+      std::size_t hashOf(const Key& key) const  { return hash(key); }
+
+      Node* find(const Key& key) const
+      {
+        for (Node* n = buckets[hash(key) & (buckets.size() - 1)]; n; n = n->hashNext)
+          if (n->key == key)
+            return n;
+        return 0;
+      }
+
+      void insert(Node* n)
+      {
+        if (count >= buckets.size())
+          _rehash(buckets.size() * 2);
+
+        Node** p = _bucket(n->key);
+        n->hashNext = *p;
+        *p = n;
+        ++count;
+      }
+
+      /// removes the node from the table without deleting it
+      void remove(Node* n)
+      {
+        Node** p = _bucket(n->key);
+        while (*p != n)
+          p = &(*p)->hashNext;
+        *p = n->hashNext;
+        --count;
+      }
+
+      /// deletes all nodes
+      void clear()
+      {
+        for (typename std::vector<Node*>::iterator it = buckets.begin(); it != buckets.end(); ++it)
+        {
+          Node* n = *it;
+          while (n)
+          {
+            Node* next = n->hashNext;
+            delete n;
+            n = next;
+          }
+          *it = 0;
+        }
+        count = 0;
+      }
+  };
+
+}
+
+#endif // ZIM_CACHELIST_H
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_CACHEPOLICY_H
+#define ZIM_CACHEPOLICY_H
+
+#include <string>
+#include <cstddef>
+#include <zim/noncopyable.h>
+#include <zim/cache.h>
+#include <zim/tinylfucache.h>
+#include <zim/arccache.h>
+
+namespace zim
+{
+  enum CachePolicy
+  {
+    cachePolicyWinnerLooser,  // Cache
+    cachePolicyTinyLfu,       // TinyLfuCache
+    cachePolicyArc            // ArcCache
+  };
+
+  /// Returns the policy with the passed name ("winnerlooser", "tinylfu"
+  /// or "arc"); throws std::runtime_error, if the name is unknown.
+  CachePolicy getCachePolicy(const std::string& name);
+
+  /// returns the name of the policy
+  const char* getCachePolicyName(CachePolicy policy);
+
+  /**
+     Interface of the caches, which allows choosing the cache policy at
+     runtime. The methods are the same as of Cache.
+   */
+  template <typename Key, typename Value>
+  class BasicCache : private NonCopyable
+  {
+    public:
+      typedef std::size_t size_type;
+
+      virtual ~BasicCache()  { }
+
+      virtual CachePolicy getPolicy() const = 0;
+
+      virtual size_type size() const = 0;
+      virtual size_type getMaxElements() const = 0;
+      virtual void setMaxElements(size_type maxElements) = 0;
+      virtual size_type getCost() const = 0;
+      virtual size_type getPeakCost() const = 0;
+      virtual size_type getMaxCost() const = 0;
+      virtual void setMaxCost(size_type maxCost) = 0;
+      virtual size_type getOverhead() const = 0;
+
+      virtual bool erase(const Key& key) = 0;
+      virtual void clear(bool stats) = 0;
+      virtual void put(const Key& key, const Value& value, size_type cost) = 0;
+      virtual void put_top(const Key& key, const Value& value, size_type cost) = 0;
+      virtual bool contains(const Key& key) = 0;
+      virtual Value* getptr(const Key& key) = 0;
+
+      virtual uint64_t getHits() const = 0;
+      virtual uint64_t getMisses() const = 0;
+      virtual uint64_t getEvictions() const = 0;
+  };
+
+  /// implements BasicCache with the cache class Impl
+  template <typename Impl, typename Key, typename Value>
+  class PolicyCache : public BasicCache<Key, Value>
+  {
+      Impl cache;
+      CachePolicy policy;
+
+    public:
+      typedef typename BasicCache<Key, Value>::size_type size_type;
+
+      PolicyCache(CachePolicy policy_, size_type maxElements, size_type maxCost)
+        : cache(maxElements, maxCost),
+          policy(policy_)
+        { }
+
+      CachePolicy getPolicy() const                 { return policy; }
+
+      size_type size() const                        { return cache.size(); }
+      size_type getMaxElements() const              { return cache.getMaxElements(); }
+      void setMaxElements(size_type maxElements)    { cache.setMaxElements(maxElements); }
+      size_type getCost() const                     { return cache.getCost(); }
+      size_type getPeakCost() const                 { return cache.getPeakCost(); }
+      size_type getMaxCost() const                  { return cache.getMaxCost(); }
+      void setMaxCost(size_type maxCost)            { cache.setMaxCost(maxCost); }
+      size_type getOverhead() const                 { return cache.getOverhead(); }
+
+      bool erase(const Key& key)                    { return cache.erase(key); }
+      void clear(bool stats)                        { cache.clear(stats); }
+      void put(const Key& key, const Value& value, size_type cost)
+        { cache.put(key, value, cost); }
+      void put_top(const Key& key, const Value& value, size_type cost)
+        { cache.put_top(key, value, cost); }
+      bool contains(const Key& key)                 { return cache.contains(key); }
+      Value* getptr(const Key& key)                 { return cache.getptr(key); }
+
+      uint64_t getHits() const                      { return cache.getHits(); }
+      uint64_t getMisses() const                    { return cache.getMisses(); }
+      uint64_t getEvictions() const                 { return cache.getEvictions(); }
+  };
+
+  /// creates a cache with the passed policy
+  template <typename Key, typename Value, typename Hash>
+  BasicCache<Key, Value>* createCache(CachePolicy policy, std::size_t maxElements, std::size_t maxCost)
+  {
+    switch (policy)
+    {
+      case cachePolicyTinyLfu:
+        return new PolicyCache<TinyLfuCache<Key, Value, Hash>, Key, Value>(policy, maxElements, maxCost);
+
+      case cachePolicyArc:
+        return new PolicyCache<ArcCache<Key, Value, Hash>, Key, Value>(policy, maxElements, maxCost);
+
+      default:
+        return new PolicyCache<Cache<Key, Value, Hash>, Key, Value>(cachePolicyWinnerLooser, maxElements, maxCost);
+    }
+  }
+
+}
+
+#endif // ZIM_CACHEPOLICY_H
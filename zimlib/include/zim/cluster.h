@@ -23,8 +23,10 @@
 #include <zim/zim.h>
 #include <zim/refcounted.h>
 #include <zim/smartptr.h>
+#include <zim/bufferpool.h>
 #include <iosfwd>
 #include <vector>
+#include <cstddef>
 
 namespace zim
 {
@@ -43,7 +45,16 @@ namespace zim
       Offsets offsets;
       Data data;
 
+      // cluster data read from a file; allocated from the buffer pool
+      Buffer buffer;
+
+      // set when the blobs are not held in data; points either into memory
+      // owned by another object, e.g. a mapped file, or into buffer
+      const char* extData;
+      SmartPtr<RefCounted> extDataOwner;
+
       void read(std::istream& in);
+      size_type parseOffsets(const char* ptr, offset_type size);
       void write(std::ostream& out) const;
 
     public:
@@ -54,14 +65,43 @@ namespace zim
       bool isCompressed() const               { return compression == zimcompZip || compression == zimcompBzip2 || compression == zimcompLzma; }
 
       size_type getCount() const              { return offsets.size() - 1; }
-      const char* getData(unsigned n) const   { return &data[ offsets[n] ]; }
+      const char* getData(unsigned n) const   { return extData ? extData + offsets[n] : &data[ offsets[n] ]; }
       size_type getSize(unsigned n) const     { return offsets[n+1] - offsets[n]; }
-      size_type getSize() const               { return offsets.size() * sizeof(size_type) + data.size(); }
+      size_type getSize() const               { return offsets.size() * sizeof(size_type) + offsets.back(); }
+      /// returns the number of bytes allocated by the cluster
+      std::size_t getMemorySize() const
+        { return sizeof(ClusterImpl) + offsets.capacity() * sizeof(size_type) + data.capacity() + buffer.capacity(); }
       Blob getBlob(size_type n) const;
       void clear();
 
       void addBlob(const Blob& blob);
       void addBlob(const char* data, unsigned size);
+
+      /// Initializes the cluster from uncompressed cluster data (without the
+      /// leading compression flag) in memory. The data is not copied but
+      /// referenced, so owner is kept alive as long as the cluster is used.
+      /// Returns false if the data does not hold a valid cluster.
+      bool readMapped(const char* ptr, offset_type size, RefCounted* owner);
+
+      /// Initializes the cluster from the cluster data including the leading
+      /// compression flag in memory. Compressed data is decompressed with a
+      /// single call into the cluster and the offsets are parsed in place;
+      /// uncompressed data is copied. Returns false if the data does not
+      /// hold a valid cluster. When the uncompressed size is known, it is
+      /// passed as sizeHint, so that the data is allocated just once.
+      bool readBuffer(const char* ptr, offset_type size, size_type sizeHint = 0);
+
+      /// writes the cluster uncompressed without the compression flag
+      void writeUncompressed(std::ostream& out) const  { write(out); }
+
+      /// Initializes the cluster with a single blob, which references size
+      /// bytes at ptr. The owner is kept alive as long as the cluster is used.
+      void setMappedBlob(const char* ptr, size_type size, RefCounted* owner);
+
+      /// Appends a blob of size bytes and returns a pointer to its
+      /// uninitialized data, which is to be filled by the caller. The data
+      /// is allocated from the buffer pool.
+      char* appendBlob(size_type size);
   };
 
   class Cluster
@@ -89,11 +129,19 @@ namespace zim
 
       size_type count() const   { return impl ? impl->getCount() : 0; }
       size_type size() const    { return impl ? impl->getSize(): sizeof(size_type); }
+      std::size_t memorySize() const  { return impl ? impl->getMemorySize() : 0; }
       void clear()              { if (impl) impl->clear(); }
 
       void addBlob(const char* data, unsigned size) { getImpl()->addBlob(data, size); }
       void addBlob(const Blob& blob)                { getImpl()->addBlob(blob); }
 
+      bool readMapped(const char* ptr, offset_type size, RefCounted* owner)
+        { return getImpl()->readMapped(ptr, size, owner); }
+      bool readBuffer(const char* ptr, offset_type size, size_type sizeHint = 0)
+        { return getImpl()->readBuffer(ptr, size, sizeHint); }
+      void writeUncompressed(std::ostream& out) const
+        { impl->writeUncompressed(out); }
+
       operator bool() const   { return impl; }
   };
 
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_CLUSTERDISKCACHE_H
+#define ZIM_CLUSTERDISKCACHE_H
+
+#include <string>
+#include <deque>
+#include <zim/zim.h>
+#include <zim/uuid.h>
+#include <zim/cluster.h>
+#include <zim/mutex.h>
+#include <zim/thread.h>
+
+namespace zim
+{
+  /**
+     Directory of decompressed clusters, which is shared by all processes
+     reading the same zim files.
+
+     Each cluster is stored in a file named by the uuid of the zim file and
+     the cluster number. The file is mapped when read, so that the
+     uncompressed data is shared by the processes through the page cache
+     and survives restarts.
+
+     A file is written to a temporary file and renamed, so that readers
+     never see partially written clusters, even when several processes
+     create the same file at the same time. The files are written by a
+     background thread, so that the reader, which decompressed the cluster,
+     does not wait for the write and the eviction. When the thread is busy,
+     at most maxQueued clusters are queued; further clusters are not
+     written. When the directory grows above the maximum size, the least
+     recently used files are removed until it is at 3/4 of the maximum. A
+     file is touched when it is read, but at most once per minute, so that
+     hits rarely cost a metadata write.
+
+     A file is only used, when the offset and the compressed size of the
+     cluster in the zim file match the header and the cluster has the
+     blob count noted there.
+
+     The cache is not available on Windows.
+
+     File format:
+       8 bytes magic "ZIMCLUS2", 1 byte compression of the cluster in the
+       zim file, 8 bytes offset and 8 bytes size of the compressed cluster
+       in the zim file, 4 bytes blob count, then the cluster uncompressed
+       including its compression flag.
+   */
+  class ClusterDiskCache : private Thread
+  {
+      struct Job
+      {
+        size_type idx;
+        offset_type offset;
+        offset_type size;
+        Cluster cluster;
+      };
+
+      std::string dir;
+      std::string prefix;
+      offset_type maxBytes;
+
+      bool useMmap;
+
+      Mutex mutex;
+      Condition workCond;   // signals the thread, that there is work or it should stop
+      Condition idleCond;   // signals flush(), that the queue is written
+      std::deque<Job> queue;
+      bool writing;
+      bool stop;
+      offset_type bytes;
+      unsigned tmpCount;
+
+      std::string path(size_type idx) const;
+      void evict();
+      void write(const Job& job);
+      void run();
+
+    public:
+      static const unsigned maxQueued = 16;
+
+      ClusterDiskCache()
+        : maxBytes(0),
+          useMmap(true),
+          writing(false),
+          stop(false),
+          bytes(0),
+          tmpCount(0)
+        { }
+
+      /// Writes the queued clusters and stops the thread.
+      ~ClusterDiskCache();
+
+      /// Enables the cache for the zim file with the passed uuid. The files
+      /// are stored in dir, which is created if needed.
+      void open(const std::string& dir, const Uuid& uuid, offset_type maxBytes);
+
+      bool enabled() const   { return !dir.empty(); }
+
+      /// Returns the cluster idx, which is found at offset with size bytes
+      /// in the zim file, or an empty cluster, if not found or not valid.
+      Cluster get(size_type idx, offset_type offset, offset_type size);
+
+      /// Queues a decompressed cluster for writing; errors are logged and
+      /// ignored.
+      void put(size_type idx, offset_type offset, offset_type size, const Cluster& cluster);
+
+      /// Waits until the queued clusters are written.
+      void flush();
+  };
+
+}
+
+#endif // ZIM_CLUSTERDISKCACHE_H
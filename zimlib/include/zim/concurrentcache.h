@@ -0,0 +1,337 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_CONCURRENTCACHE_H
+#define ZIM_CONCURRENTCACHE_H
+
+#include <vector>
+#include <utility>
+#include <zim/atomic.h>
+#include <zim/cachepolicy.h>
+#include <zim/mutex.h>
+#include <zim/noncopyable.h>
+
+namespace zim
+{
+  /**
+     A cache, which may be used by multiple threads.
+
+     The elements are distributed by the hash of the key to a number of
+     shards. Each shard is a cache with its own mutex, so threads accessing
+     different shards do not block each other. The cache policy passed to
+     the constructor (see CachePolicy) is applied within each shard; by
+     default it is the winner/looser algorithm of Cache.
+
+     Values are always returned as copies, since a pointer into the cache
+     would not be valid after the lock is released.
+
+     The maximum number of elements and the maximum cost are distributed
+     evenly over the shards. When no number of shards is passed to the
+     constructor, it is chosen, so that each shard holds at least 64
+     elements and, if the cost is limited, at least 16MB of cost. Small
+     caches therefore have just one shard and behave exactly like a single
+     cache of the policy.
+   */
+  template <typename Key, typename Value, typename Hash = CacheHash<Key> >
+  class ConcurrentCache : private NonCopyable
+  {
+    public:
+      typedef typename BasicCache<Key, Value>::size_type size_type;
+      typedef Value value_type;
+
+      enum { maxShards = 16, minShardSize = 64, minShardCost = 16 * 1024 * 1024 };
+
+    private:
+      struct Shard
+      {
+        Mutex mutex;
+        BasicCache<Key, Value>* cache;
+
+        Shard(CachePolicy policy, size_type maxElements, size_type maxCost)
+          : cache(createCache<Key, Value, Hash>(policy, maxElements, maxCost))
+          { }
+
+        ~Shard()
+          { delete cache; }
+      };
+
+      std::vector<Shard*> shards;
+      size_type maxElements;
+      size_type maxCost;
+      volatile size_type cost;
+      volatile size_type peakCost;
+      Hash hash;
+
+      Shard& _shard(const Key& key)
+      {
+        // the low bits of the hash select the bucket in the shard, so the
+        // high bits are used here
+        std::size_t h = hash(key);
+        return *shards[(h >> (sizeof(std::size_t) * 8 - 8)) & (shards.size() - 1)];
+      }
+
+      // the parts of all shards sum up to total; does not overflow for the
+      // largest total
+      size_type _part(size_type total, unsigned n) const
+        { return total / shards.size() + (n < total % shards.size() ? 1 : 0); }
+
+      // adds the change of the cost of a shard to the total and updates
+      // the peak; called while the shard is locked
+      void _addCost(size_type before, size_type after)
+      {
+        size_type c = atomicAdd(cost, after - before);
+        size_type p;
+        while (c > (p = peakCost) && !atomicCompareExchange(peakCost, p, c))
+          ;
+      }
+
+    public:
+      explicit ConcurrentCache(size_type maxElements_, size_type maxCost_ = 0, unsigned numShards = 0,
+                               CachePolicy policy = cachePolicyWinnerLooser)
+        : maxElements(maxElements_),
+          maxCost(maxCost_),
+          cost(0),
+          peakCost(0)
+      {
+        if (numShards == 0)
+        {
+          numShards = 1;
+          while (numShards < maxShards
+            && maxElements / (numShards * 2) >= minShardSize
+            && (maxCost == 0 || maxCost / (numShards * 2) >= minShardCost))
+            numShards *= 2;
+        }
+        else
+        {
+          // round down to a power of 2
+          unsigned n = 1;
+          while (n * 2 <= numShards && n < 256)
+            n *= 2;
+          numShards = n;
+        }
+
+        shards.reserve(numShards);
+        for (unsigned n = 0; n < numShards; ++n)
+          shards.push_back(0);
+        for (unsigned n = 0; n < numShards; ++n)
+          shards[n] = new Shard(policy, _part(maxElements, n), _part(maxCost, n));
+      }
+
+      ~ConcurrentCache()
+      {
+        for (typename std::vector<Shard*>::iterator it = shards.begin(); it != shards.end(); ++it)
+          delete *it;
+      }
+
+      /// returns the number of shards
+      unsigned getShardCount() const    { return shards.size(); }
+
+      /// returns the cache policy of the shards
+      CachePolicy getPolicy() const     { return shards[0]->cache->getPolicy(); }
+
+      /// returns the number of elements currently in the cache
+      size_type size() const
+      {
+        size_type ret = 0;
+        for (typename std::vector<Shard*>::const_iterator it = shards.begin(); it != shards.end(); ++it)
+        {
+          MutexLock lock((*it)->mutex);
+          ret += (*it)->cache->size();
+        }
+        return ret;
+      }
+
+      /// returns the maximum number of elements in the cache
+      size_type getMaxElements() const      { return maxElements; }
+
+      void setMaxElements(size_type maxElements_)
+      {
+        maxElements = maxElements_;
+        for (unsigned n = 0; n < shards.size(); ++n)
+        {
+          MutexLock lock(shards[n]->mutex);
+          size_type before = shards[n]->cache->getCost();
+          shards[n]->cache->setMaxElements(_part(maxElements, n));
+          _addCost(before, shards[n]->cache->getCost());
+        }
+      }
+
+      /// returns the sum of the costs of the elements in the cache
+      size_type getCost() const     { return cost; }
+
+      /// returns the highest total cost since the last reset of the statistics
+      size_type getPeakCost() const { return peakCost; }
+
+      /// returns the maximum cost of the cache or 0 if not limited
+      size_type getMaxCost() const  { return maxCost; }
+
+      void setMaxCost(size_type maxCost_)
+      {
+        maxCost = maxCost_;
+        for (unsigned n = 0; n < shards.size(); ++n)
+        {
+          MutexLock lock(shards[n]->mutex);
+          size_type before = shards[n]->cache->getCost();
+          shards[n]->cache->setMaxCost(_part(maxCost, n));
+          _addCost(before, shards[n]->cache->getCost());
+        }
+      }
+
+      /// returns the estimated number of bytes used for managing the
+      /// elements in all shards
+      size_type getOverhead() const
+      {
+        size_type ret = 0;
+        for (typename std::vector<Shard*>::const_iterator it = shards.begin(); it != shards.end(); ++it)
+        {
+          MutexLock lock((*it)->mutex);
+          ret += (*it)->cache->getOverhead();
+        }
+        return ret;
+      }
+
+      /// removes a element from the cache and returns true, if found
+      bool erase(const Key& key)
+      {
+        Shard& s = _shard(key);
+        MutexLock lock(s.mutex);
+        size_type before = s.cache->getCost();
+        bool ret = s.cache->erase(key);
+        _addCost(before, s.cache->getCost());
+        return ret;
+      }
+
+      /// clears the cache.
+      void clear(bool stats = false)
+      {
+        for (typename std::vector<Shard*>::iterator it = shards.begin(); it != shards.end(); ++it)
+        {
+          MutexLock lock((*it)->mutex);
+          size_type before = (*it)->cache->getCost();
+          (*it)->cache->clear(stats);
+          _addCost(before, 0);
+        }
+
+        if (stats)
+          peakCost = cost;
+      }
+
+      /// puts a new element in the cache (see Cache::put).
+      void put(const Key& key, const Value& value, size_type elementCost = 1)
+      {
+        Shard& s = _shard(key);
+        MutexLock lock(s.mutex);
+        size_type before = s.cache->getCost();
+        s.cache->put(key, value, elementCost);
+        _addCost(before, s.cache->getCost());
+      }
+
+      /// puts a new element on the top of the cache (see Cache::put_top).
+      void put_top(const Key& key, const Value& value, size_type elementCost = 1)
+      {
+        Shard& s = _shard(key);
+        MutexLock lock(s.mutex);
+        size_type before = s.cache->getCost();
+        s.cache->put_top(key, value, elementCost);
+        _addCost(before, s.cache->getCost());
+      }
+
+      /// returns a pair of values - a flag, if the value was found and the
+      /// value if found or the passed default otherwise.
+      std::pair<bool, Value> getx(const Key& key, Value def = Value())
+      {
+        Shard& s = _shard(key);
+        MutexLock lock(s.mutex);
+        Value* v = s.cache->getptr(key);
+        return v ? std::pair<bool, Value>(true, *v)
+                 : std::pair<bool, Value>(false, def);
+      }
+
+      /// returns true, if the key is found (see Cache::contains).
+      bool contains(const Key& key)
+      {
+        Shard& s = _shard(key);
+        MutexLock lock(s.mutex);
+        return s.cache->contains(key);
+      }
+
+      /// returns the value to a key or the passed default value if not found.
+      Value get(const Key& key, Value def = Value())
+      {
+        return getx(key, def).second;
+      }
+
+      /// returns the number of hits.
+      uint64_t getHits() const
+      {
+        uint64_t ret = 0;
+        for (typename std::vector<Shard*>::const_iterator it = shards.begin(); it != shards.end(); ++it)
+        {
+          MutexLock lock((*it)->mutex);
+          ret += (*it)->cache->getHits();
+        }
+        return ret;
+      }
+
+      /// returns the number of misses.
+      uint64_t getMisses() const
+      {
+        uint64_t ret = 0;
+        for (typename std::vector<Shard*>::const_iterator it = shards.begin(); it != shards.end(); ++it)
+        {
+          MutexLock lock((*it)->mutex);
+          ret += (*it)->cache->getMisses();
+        }
+        return ret;
+      }
+
+      /// returns the number of elements dropped, because the cache was full.
+      uint64_t getEvictions() const
+      {
+        uint64_t ret = 0;
+        for (typename std::vector<Shard*>::const_iterator it = shards.begin(); it != shards.end(); ++it)
+        {
+          MutexLock lock((*it)->mutex);
+          ret += (*it)->cache->getEvictions();
+        }
+        return ret;
+      }
+
+      /// returns the cache hit ratio between 0 and 1.
+      double hitRatio() const
+      {
+        uint64_t hits = getHits();
+        uint64_t misses = getMisses();
+        return hits+misses > 0 ? static_cast<double>(hits)/static_cast<double>(hits+misses) : 0;
+      }
+
+      /// returns the ratio, between held elements and maximum elements or
+      /// the ratio between the cost and the maximum cost, if set.
+      double fillfactor() const
+      {
+        return maxCost > 0     ? static_cast<double>(getCost()) / static_cast<double>(maxCost)
+             : maxElements > 0 ? static_cast<double>(size()) / static_cast<double>(maxElements)
+             : 0;
+      }
+
+  };
+
+}
+
+#endif // ZIM_CONCURRENTCACHE_H
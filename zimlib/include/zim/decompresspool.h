@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_DECOMPRESSPOOL_H
+#define ZIM_DECOMPRESSPOOL_H
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <zim/zim.h>
+#include <zim/cluster.h>
+#include <zim/mutex.h>
+#include <zim/thread.h>
+
+namespace zim
+{
+  class FileImpl;
+
+  /**
+     Pool of threads, which read and decompress clusters in parallel.
+
+     The clusters are passed as jobs through a queue, which holds at most
+     twice the number of threads. A caller, which passes more jobs, blocks
+     until there is space, so that the number of clusters, which are
+     decompressed or waiting at the same time, stays limited.
+
+     The threads are started on first use.
+   */
+  class DecompressPool : private NonCopyable
+  {
+    public:
+      struct Job
+      {
+        size_type idx;
+        Cluster cluster;
+        std::string error;   // set, when reading the cluster failed
+        bool done;
+
+        explicit Job(size_type idx_ = 0)
+          : idx(idx_),
+            done(false)
+          { }
+      };
+
+    private:
+      class Worker : public Thread
+      {
+          DecompressPool& pool;
+          unsigned number;
+
+        protected:
+          void run();
+
+        public:
+          Worker(DecompressPool& pool_, unsigned number_)
+            : pool(pool_),
+              number(number_)
+            { }
+      };
+
+      FileImpl& file;
+
+      Mutex mutex;
+      Condition workCond;    // signals the workers, that there are jobs or they should stop
+      Condition spaceCond;   // signals callers, that there is space in the queue
+      Condition doneCond;    // signals callers, that jobs are done
+
+      std::deque<Job*> queue;
+      std::vector<Worker*> workers;
+      volatile unsigned threads;
+      bool stop;
+
+      unsigned maxQueue() const   { return threads > 0 ? threads * 2 : 2; }
+      void startWorkers();
+      void work(unsigned number);
+
+    public:
+      explicit DecompressPool(FileImpl& file);
+      ~DecompressPool();
+
+      /// Sets the number of threads; 0 disables the pool, so that clusters
+      /// are read by the calling thread. Workers above the number are kept
+      /// idle.
+      void setThreads(unsigned threads);
+      unsigned getThreads() const   { return threads; }
+
+      /// Reads the clusters of the jobs and returns, when all are done.
+      void load(std::vector<Job>& jobs);
+  };
+
+}
+
+#endif // ZIM_DECOMPRESSPOOL_H
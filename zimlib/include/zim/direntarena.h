@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_DIRENTARENA_H
+#define ZIM_DIRENTARENA_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <zim/zim.h>
+#include <zim/dirent.h>
+#include <zim/noncopyable.h>
+
+namespace zim
+{
+  /**
+     Holds all directory entries of a zim file in memory.
+
+     Each entry is a fixed size record with the numeric fields. The url,
+     title and parameter of all entries are kept in a single character
+     array, so that lookups by url or title need neither I/O nor string
+     allocations.
+
+     The entries are added in url order. The title index, which maps the
+     title order to the url order, is set separately.
+   */
+  class DirentArena : private NonCopyable
+  {
+      struct Record
+      {
+        std::size_t strOffset;      // url, title and parameter in strings
+        size_type version;
+        size_type clusterNumber;    // redirect index for redirects
+        size_type blobNumber;
+        uint32_t urlSize;
+        uint32_t titleSize;         // 0 if the title equals the url
+        uint16_t mimeType;
+        char ns;
+        uint8_t parameterSize;
+      };
+
+      std::vector<Record> records;
+      std::vector<char> strings;
+      std::vector<size_type> titleIdx;
+
+      const char* url(const Record& r) const
+        { return strings.empty() ? "" : &strings[0] + r.strOffset; }
+      const char* title(const Record& r) const
+        { return r.titleSize ? url(r) + r.urlSize : url(r); }
+      std::size_t titleSize(const Record& r) const
+        { return r.titleSize ? r.titleSize : r.urlSize; }
+
+      static int compare(char ns, const std::string& s, char rns, const char* p, std::size_t size)
+        { return ns < rns ? -1 : ns > rns ? 1 : s.compare(0, s.size(), p, size); }
+
+    public:
+      DirentArena()  { }
+
+      /// reserves space for count entries
+      void reserve(size_type count)   { records.reserve(count); }
+
+      /// appends a directory entry; entries must be added in url order
+      void add(const Dirent& dirent);
+
+      /// sets the title index; the passed vector is emptied
+      void setTitleIndex(std::vector<size_type>& idx)   { titleIdx.swap(idx); }
+
+      bool empty() const         { return records.empty(); }
+      size_type size() const     { return records.size(); }
+
+      /// returns the memory used by the arena in bytes
+      std::size_t getMemorySize() const
+        { return records.capacity() * sizeof(Record) + strings.capacity() + titleIdx.capacity() * sizeof(size_type); }
+
+      Dirent getDirent(size_type idx) const;
+      size_type getIndexByTitle(size_type idx) const   { return titleIdx[idx]; }
+      char getNamespace(size_type idx) const           { return records[idx].ns; }
+
+      /// returns the index of the first entry in namespace ns or the index
+      /// of the next namespace if not found
+      size_type getNamespaceBeginOffset(char ns) const;
+      /// returns the index after the last entry in namespace ns
+      size_type getNamespaceEndOffset(char ns) const;
+
+      /// Searches an entry by url. Returns a flag, if it was found and the
+      /// index of the entry or where it would be inserted.
+      std::pair<bool, size_type> findx(char ns, const std::string& url) const;
+
+      /// Searches an entry by title. Returns a flag, if it was found and the
+      /// position in title order of the entry or where it would be inserted.
+      std::pair<bool, size_type> findxByTitle(char ns, const std::string& title) const;
+  };
+
+}
+
+#endif // ZIM_DIRENTARENA_H
@@ -22,6 +22,7 @@
 
 #include <string>
 #include <iterator>
+#include <vector>
 #include <zim/zim.h>
 #include <zim/fileimpl.h>
 #include <zim/blob.h>
@@ -38,8 +39,8 @@ namespace zim
     public:
       File()
         { }
-      explicit File(const std::string& fname)
-        : impl(new FileImpl(fname.c_str()))
+      explicit File(const std::string& fname, int flags = zimopenDefault)
+        : impl(new FileImpl(fname.c_str(), flags))
         { }
 
       const std::string& getFilename() const   { return impl->getFilename(); }
@@ -55,13 +56,46 @@ namespace zim
       Article getArticleByUrl(const std::string& url);
       Article getArticleByTitle(size_type idx);
       Article getArticleByTitle(char ns, const std::string& title);
+      Article getArticleByClusterOrder(size_type idx);
 
       Cluster getCluster(size_type idx) const  { return impl->getCluster(idx); }
       size_type getCountClusters() const       { return impl->getCountClusters(); }
       offset_type getClusterOffset(size_type idx) const    { return impl->getClusterOffset(idx); }
+      CachePolicy getDirentCachePolicy() const     { return impl->getDirentCachePolicy(); }
+      uint64_t getDirentCacheHits() const          { return impl->getDirentCacheHits(); }
+      uint64_t getDirentCacheMisses() const        { return impl->getDirentCacheMisses(); }
+      std::size_t getDirentCacheOverhead() const   { return impl->getDirentCacheOverhead(); }
+      std::size_t getClusterCacheBytes() const     { return impl->getClusterCacheBytes(); }
+      std::size_t getClusterCachePeakBytes() const { return impl->getClusterCachePeakBytes(); }
+      uint64_t getClusterCacheHits() const         { return impl->getClusterCacheHits(); }
+      uint64_t getClusterCacheMisses() const       { return impl->getClusterCacheMisses(); }
+      CachePolicy getClusterCachePolicy() const    { return impl->getClusterCachePolicy(); }
+      std::size_t getClusterCacheOverhead() const  { return impl->getClusterCacheOverhead(); }
+      std::size_t getRawClusterCacheBytes() const  { return impl->getRawClusterCacheBytes(); }
+      uint64_t getRawClusterCacheHits() const      { return impl->getRawClusterCacheHits(); }
+      uint64_t getRawClusterCacheMisses() const    { return impl->getRawClusterCacheMisses(); }
+      void setClusterDirectory(const std::string& dir, offset_type maxBytes)
+        { impl->setClusterDirectory(dir, maxBytes); }
+      void setTrace(const std::string& filename)   { impl->setTrace(filename); }
+      /// installs a observer, which is called after each reader operation
+      /// (see FileObserver); 0 removes it
+      void setObserver(FileObserver* observer)     { impl->setObserver(observer); }
+      /// returns a snapshot of the performance counters of the file
+      FileStats getStats() const                   { return impl->getStats(); }
+
+      std::vector<Cluster> getClusters(const std::vector<size_type>& idx)
+        { return impl->getClusters(idx); }
+      void setDecompressThreads(unsigned n)    { impl->setDecompressThreads(n); }
+      unsigned getDecompressThreads() const    { return impl->getDecompressThreads(); }
+
+      void setReadahead(unsigned depth)        { impl->setReadahead(depth); }
+      unsigned getReadahead() const            { return impl->getReadahead(); }
+      void cancelReadahead()                   { impl->cancelReadahead(); }
 
       Blob getBlob(size_type clusterIdx, size_type blobIdx)
-        { return getCluster(clusterIdx).getBlob(blobIdx); }
+        { return impl->getBlob(clusterIdx, blobIdx); }
+      std::vector<Blob> getArticleData(const std::vector<size_type>& idx)
+        { return impl->getArticleData(idx); }
 
       size_type getNamespaceBeginOffset(char ch)
         { return impl->getNamespaceBeginOffset(ch); }
@@ -78,6 +112,10 @@ namespace zim
 
       const_iterator begin();
       const_iterator beginByTitle();
+      /// Iterates the articles in the order of their data in the file, so
+      /// that each cluster is read just once. Articles without data
+      /// follow at the end.
+      const_iterator beginByCluster();
       const_iterator end();
       std::pair<bool, const_iterator> findx(char ns, const std::string& url);
       std::pair<bool, const_iterator> findx(const std::string& url);
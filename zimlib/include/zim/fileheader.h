@@ -41,9 +41,12 @@ namespace zim
       static const size_type zimMagic;
       static const size_type zimVersion;
       static const size_type size;
+      static const uint16_t clusterInfoMinorVersion;
+      static const size_type clusterInfoSize;
 
     private:
       Uuid uuid;
+      uint16_t minorVersion;
       size_type articleCount;
       offset_type titleIdxPos;
       offset_type urlPtrPos;
@@ -53,22 +56,29 @@ namespace zim
       size_type mainPage;
       size_type layoutPage;
       offset_type checksumPos;
+      offset_type clusterInfoPos;
 
     public:
       Fileheader()
-        : articleCount(0),
+        : minorVersion(0),
+          articleCount(0),
           titleIdxPos(0),
           urlPtrPos(0),
+          mimeListPos(size),
           blobCount(0),
           blobPtrPos(0),
           mainPage(std::numeric_limits<size_type>::max()),
           layoutPage(std::numeric_limits<size_type>::max()),
-          checksumPos(std::numeric_limits<offset_type>::max())
+          checksumPos(std::numeric_limits<offset_type>::max()),
+          clusterInfoPos(0)
       {}
 
       const Uuid& getUuid() const                  { return uuid; }
       void setUuid(const Uuid& uuid_)              { uuid = uuid_; }
 
+      uint16_t    getMinorVersion() const          { return minorVersion; }
+      void        setMinorVersion(uint16_t v)      { minorVersion = v; }
+
       size_type getArticleCount() const            { return articleCount; }
       void      setArticleCount(size_type s)       { articleCount = s; }
 
@@ -98,6 +108,14 @@ namespace zim
       bool        hasChecksum() const              { return getMimeListPos() >= 80; }
       offset_type getChecksumPos() const           { return hasChecksum() ? checksumPos : 0; }
       void        setChecksumPos(offset_type p)    { checksumPos = p; }
+
+      // The cluster info table holds for each cluster the size of the
+      // uncompressed cluster data and the number of blobs as 2 32 bit
+      // values. It is optional and marked by the minor version; the
+      // header of such files is extended by the 64 bit pointer to it.
+      bool        hasClusterInfo() const           { return minorVersion >= clusterInfoMinorVersion && clusterInfoPos != 0; }
+      offset_type getClusterInfoPos() const        { return hasClusterInfo() ? clusterInfoPos : 0; }
+      void        setClusterInfoPos(offset_type p) { clusterInfoPos = p; }
   };
 
   std::ostream& operator<< (std::ostream& out, const Fileheader& fh);
@@ -23,37 +23,121 @@
 #include <string>
 #include <vector>
 #include <map>
-#include <zim/fstream.h>
+#include <zim/filereader.h>
+#include <zim/mutex.h>
 #include <zim/refcounted.h>
+#include <zim/atomic.h>
 #include <zim/zim.h>
 #include <zim/fileheader.h>
-#include <zim/cache.h>
+#include <zim/concurrentcache.h>
 #include <zim/dirent.h>
+#include <zim/direntarena.h>
+#include <zim/urlindex.h>
 #include <zim/cluster.h>
+#include <zim/clusterdiskcache.h>
+#include <zim/accesstrace.h>
+#include <zim/filestats.h>
+#include <zim/fileobserver.h>
+#include <zim/blob.h>
+#include <zim/readahead.h>
+#include <zim/decompresspool.h>
 
 namespace zim
 {
+  /**
+     The implementation of zim::File.
+
+     A FileImpl may be shared between threads. The file is read using
+     positional reads, so there is no shared file position, and the caches
+     are sharded and protected by mutexes.
+   */
   class FileImpl : public RefCounted
   {
-      ifstream zimFile;
+      FileReader zimFile;
       Fileheader header;
       std::string filename;
 
-      Cache<size_type, Dirent> direntCache;
-      Cache<offset_type, Cluster> clusterCache;
+      ConcurrentCache<size_type, Dirent> direntCache;
+      ConcurrentCache<offset_type, Cluster> clusterCache;
+      // compressed cluster data behind the cluster cache; disabled, when
+      // the maximum cost is 0
+      ConcurrentCache<size_type, Blob> rawClusterCache;
+      // decompressed clusters shared with other processes
+      ClusterDiskCache clusterDiskCache;
+      // records the cache accesses into the trace of the process, when set
+      AccessTrace* trace;
+      unsigned traceFile;
+      // called after each reader operation, when set; not owned
+      FileObserver* observer;
+
+      // performance counters besides the counters of the caches (see
+      // getStats); updated atomically
+      mutable volatile uint64_t direntBytesRead;
+      mutable volatile uint64_t clusterBytesRead[FileStats::compressionTypes];
+      mutable volatile uint64_t clustersDecompressed;
+      mutable volatile uint64_t decompressMicroseconds;
+      mutable volatile uint64_t urlLookups;
+      mutable volatile uint64_t titleLookups;
+      mutable volatile uint64_t lookupSteps;
       typedef std::map<char, size_type> NamespaceCache;
       NamespaceCache namespaceBeginCache;
       NamespaceCache namespaceEndCache;
 
       std::string namespaces;
+      Mutex namespaceMutex;
 
       typedef std::vector<std::string> MimeTypes;
       MimeTypes mimeTypes;
 
+      // Preloaded pointer lists and title index. The pointers point either
+      // to the vectors or into the mapped file and are 0, when the file is
+      // not opened with zimopenPreload.
+      std::vector<offset_type> urlPtrs;
+      std::vector<offset_type> clusterPtrs;
+      std::vector<size_type> titleIdx;
+      std::vector<size_type> clusterInfo;
+      const offset_type* urlPtrList;
+      const offset_type* clusterPtrList;
+      const size_type* titleIdxList;
+      const size_type* clusterInfoList;
+
+      // all directory entries, when opened with zimopenResident
+      DirentArena direntArena;
+
+      // hash index for urls, when opened with zimopenUrlIndex
+      UrlIndex urlIndex;
+
+      // article indexes sorted by cluster and blob number; created on first use
+      std::vector<size_type> clusterOrder;
+      Mutex clusterOrderMutex;
+
+      // declared last, so that the threads are stopped before the other
+      // members are destroyed
+      DecompressPool decompressPool;
+      ClusterReadahead readahead;
+      friend class DecompressPool;
+      friend class ClusterReadahead;
+
+      template <typename T>
+      const T* preload(std::vector<T>& vec, offset_type pos, size_type count);
+      void loadDirentArena();
+      void loadUrlIndex();
+      void createClusterOrder();
+      Dirent readDirent(size_type idx);
+      offset_type getClusterEnd(size_type idx);
+      Cluster readCluster(size_type idx, offset_type clusterOffset);
+      bool decodeCluster(Cluster& cluster, const char* data, offset_type size, size_type sizeHint);
+      Cluster prefetchCluster(size_type idx);
+      bool isClusterCompressed(offset_type clusterOffset);
+      bool getClusterInfo(size_type idx, size_type& size, size_type& count);
+
       offset_type getOffset(offset_type ptrOffset, size_type idx);
 
+      bool tracing() const   { return trace && trace->enabled(); }
+
     public:
-      explicit FileImpl(const char* fname);
+      explicit FileImpl(const char* fname, int flags = zimopenDefault);
+      ~FileImpl();
 
       time_t getMTime() const   { return zimFile.getMTime(); }
 
@@ -64,11 +148,98 @@ namespace zim
       Dirent getDirent(size_type idx);
       Dirent getDirentByTitle(size_type idx);
       size_type getIndexByTitle(size_type idx);
+      size_type getIndexByClusterOrder(size_type idx);
       size_type getCountArticles() const       { return header.getArticleCount(); }
 
+      /// returns the resident directory or 0, if not opened with zimopenResident
+      const DirentArena* getDirentArena() const
+        { return direntArena.empty() ? 0 : &direntArena; }
+
+      /// returns the url index or 0, if not opened with zimopenUrlIndex
+      const UrlIndex* getUrlIndex() const
+        { return urlIndex.empty() ? 0 : &urlIndex; }
+
       Cluster getCluster(size_type idx);
+      /// Returns the clusters with the passed indexes in the same order. The
+      /// clusters, which are not cached, are decompressed in parallel by the
+      /// decompress pool, if enabled.
+      std::vector<Cluster> getClusters(const std::vector<size_type>& idx);
+      /// Returns a single blob. Of uncompressed clusters, which are not
+      /// cached, only the offsets and the data of the blob are read.
+      Blob getBlob(size_type clusterIdx, size_type blobIdx);
+      /// Returns the data of the articles with the passed indexes in the
+      /// same order. The requests are grouped by cluster, so that each
+      /// cluster is read and decompressed just once. Redirects, link
+      /// targets and deleted articles have no data.
+      std::vector<Blob> getArticleData(const std::vector<size_type>& idx);
       size_type getCountClusters() const       { return header.getClusterCount(); }
-      offset_type getClusterOffset(size_type idx)   { return getOffset(header.getClusterPtrPos(), idx); }
+      offset_type getClusterOffset(size_type idx);
+
+      /// Sets the number of clusters, which are read ahead in a background
+      /// thread, when clusters are accessed sequentially; 0 disables it.
+      void setReadahead(unsigned depth)        { readahead.setDepth(depth); }
+      unsigned getReadahead() const            { return readahead.getDepth(); }
+      /// drops the clusters queued for readahead
+      void cancelReadahead()                   { readahead.cancel(); }
+
+      /// Sets the number of threads, which decompress clusters in parallel
+      /// for getClusters and getArticleData; 0 disables them.
+      void setDecompressThreads(unsigned n)    { decompressPool.setThreads(n); }
+      unsigned getDecompressThreads() const    { return decompressPool.getThreads(); }
+
+      CachePolicy getDirentCachePolicy() const      { return direntCache.getPolicy(); }
+      uint64_t getDirentCacheHits() const           { return direntCache.getHits(); }
+      uint64_t getDirentCacheMisses() const         { return direntCache.getMisses(); }
+      /// returns the estimated memory used for managing the dirent cache
+      std::size_t getDirentCacheOverhead() const    { return direntCache.getOverhead(); }
+
+      /// Returns the number of bytes of the clusters in the cluster cache.
+      /// Freed cluster buffers are kept in the BufferPool in addition (up to
+      /// ZIM_BUFFERPOOL bytes per process), see FileStats::bufferPoolBytes.
+      std::size_t getClusterCacheBytes() const      { return clusterCache.getCost(); }
+      /// returns the highest number of bytes held in the cluster cache
+      std::size_t getClusterCachePeakBytes() const  { return clusterCache.getPeakCost(); }
+      uint64_t getClusterCacheHits() const          { return clusterCache.getHits(); }
+      uint64_t getClusterCacheMisses() const        { return clusterCache.getMisses(); }
+      CachePolicy getClusterCachePolicy() const     { return clusterCache.getPolicy(); }
+      /// returns the estimated memory used for managing the cluster cache
+      std::size_t getClusterCacheOverhead() const   { return clusterCache.getOverhead(); }
+
+      /// returns the number of bytes of compressed data in the raw cluster cache
+      std::size_t getRawClusterCacheBytes() const   { return rawClusterCache.getCost(); }
+      uint64_t getRawClusterCacheHits() const       { return rawClusterCache.getHits(); }
+      uint64_t getRawClusterCacheMisses() const     { return rawClusterCache.getMisses(); }
+
+      /// Stores decompressed clusters in the directory dir, where they are
+      /// found by other processes and after a restart. The directory is
+      /// limited to maxBytes. The files are written by a background thread.
+      void setClusterDirectory(const std::string& dir, offset_type maxBytes)
+        { clusterDiskCache.open(dir, header.getUuid(), maxBytes); }
+
+      /// returns a snapshot of the performance counters
+      FileStats getStats() const;
+
+      /// counts a lookup of an article by url or title, which took steps
+      /// binary search steps or probes; called by File
+      void countLookup(bool byTitle, unsigned steps)
+      {
+        atomicIncrement(byTitle ? titleLookups : urlLookups);
+        if (steps > 0)
+          atomicAdd(lookupSteps, static_cast<uint64_t>(steps));
+      }
+
+      /// Installs a observer, which is called after each reader operation
+      /// with the time it took; 0 removes it. The observer is not owned
+      /// and should be installed before the file is used by other threads.
+      void setObserver(FileObserver* observer_)  { observer = observer_; }
+      FileObserver* getObserver() const          { return observer; }
+
+      /// Records the accesses to the dirent and cluster caches into the
+      /// trace of the process (see AccessTrace), which is opened with the
+      /// filename, unless it is already open. An empty filename stops
+      /// recording the accesses of this file. Like the observer, the trace
+      /// should be set before the file is used by other threads.
+      void setTrace(const std::string& filename);
 
       size_type getNamespaceBeginOffset(char ch);
       size_type getNamespaceEndOffset(char ch);
@@ -30,7 +30,8 @@ namespace zim
     public:
       enum Mode {
         UrlIterator,
-        ArticleIterator
+        ArticleIterator,
+        ClusterIterator
       };
 
     private:
@@ -88,8 +89,9 @@ namespace zim
       const Article& operator*() const
       {
         if (!article.good())
-          article = mode == UrlIterator ? file->getArticle(idx)
-                                        : file->getArticleByTitle(idx);
+          article = mode == UrlIterator     ? file->getArticle(idx)
+                  : mode == ArticleIterator ? file->getArticleByTitle(idx)
+                  :                           file->getArticleByClusterOrder(idx);
         return article;
       }
 
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_FILEOBSERVER_H
+#define ZIM_FILEOBSERVER_H
+
+#include <zim/zim.h>
+#include <zim/latencyhistogram.h>
+
+namespace zim
+{
+  enum FileOperation
+  {
+    operationFindUrl,     // File::findx by url; idx is the found or insert position
+    operationFindTitle,   // File::findxByTitle; idx is the position in the title index
+    operationGetDirent,   // idx is the article index
+    operationGetCluster,  // idx is the cluster index
+    operationGetBlob      // idx is the cluster index
+  };
+
+  /// returns a short name of the operation like "getDirent"
+  const char* getOperationName(FileOperation op);
+
+  /**
+     Observes the reader operations of a zim file.
+
+     An observer is installed with File::setObserver. It is called by all
+     threads, which use the file, after each operation with the time it
+     took, so it must be thread safe and should return quickly. It must not
+     throw, since it may be called while an exception is propagated.
+
+     When no observer is installed, the operations are not timed at all.
+   */
+  class FileObserver
+  {
+    public:
+      virtual ~FileObserver()  { }
+
+      virtual void operationDone(FileOperation op, size_type idx, uint64_t nsecs) = 0;
+
+      /// returns the time of a monotonic clock in nanoseconds
+      static uint64_t now();
+  };
+
+  /// A observer, which collects the latencies of each operation in a
+  /// LatencyHistogram.
+  class HistogramObserver : public FileObserver
+  {
+    public:
+      enum { operationCount = operationGetBlob + 1 };
+
+    private:
+      LatencyHistogram histograms[operationCount];
+
+    public:
+      void operationDone(FileOperation op, size_type /* idx */, uint64_t nsecs)
+        { histograms[op].record(nsecs); }
+
+      /// returns the latencies of the operation in nanoseconds
+      const LatencyHistogram& getHistogram(FileOperation op) const
+        { return histograms[op]; }
+
+      void clear()
+      {
+        for (unsigned op = 0; op < operationCount; ++op)
+          histograms[op].clear();
+      }
+  };
+
+  /**
+     Times a operation and reports it to the observer, when destroyed. The
+     index may be set later, when the result is known. Without a observer
+     the clock is not read.
+   */
+  class OperationTimer
+  {
+      FileObserver* observer;
+      FileOperation op;
+      uint64_t start;
+
+    public:
+      size_type idx;
+
+      OperationTimer(FileObserver* observer_, FileOperation op_, size_type idx_ = 0)
+        : observer(observer_),
+          op(op_),
+          start(observer_ ? FileObserver::now() : 0),
+          idx(idx_)
+        { }
+
+      ~OperationTimer()
+      {
+        if (observer)
+          observer->operationDone(op, idx, FileObserver::now() - start);
+      }
+  };
+
+}
+
+#endif // ZIM_FILEOBSERVER_H
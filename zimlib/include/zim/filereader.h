@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_FILEREADER_H
+#define ZIM_FILEREADER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <time.h>
+#include <zim/zim.h>
+#include <zim/mmapfile.h>
+#include <zim/mutex.h>
+#include <zim/noncopyable.h>
+#include <zim/smartptr.h>
+
+namespace zim
+{
+  /**
+     Reads from a zim file, which may be split into several parts
+     (foo.zimaa, foo.zimab, ...), using positional reads.
+
+     The reader does not have a current position, so it can be used by
+     several threads at the same time. If a mapping of the file is
+     available, data is copied from there instead of reading it.
+   */
+  class FileReader : private NonCopyable
+  {
+      struct Part
+      {
+        std::string fname;
+        int fd;
+        offset_type offset;
+        offset_type size;
+      };
+
+      typedef std::vector<Part> Parts;
+      Parts parts;
+
+      SmartPtr<MMapFile> mmapFile;
+      time_t mtime;
+
+      // serializes seek and read on platforms without positional reads
+      mutable Mutex readMutex;
+
+      void addPart(const std::string& fname);
+      void closeParts();
+
+    public:
+      explicit FileReader(const std::string& fname);
+      ~FileReader();
+
+      /// Maps the file into memory, so that further reads are served from
+      /// the mapping. Returns false, if mapping failed.
+      bool map();
+
+      /// Reads size bytes at offset off into dest. Throws an exception,
+      /// when the data could not be read.
+      void read(char* dest, offset_type off, offset_type size) const;
+
+      /// Reads up to size bytes at offset off into dest and returns the
+      /// number of bytes read, which is less than size at end of file.
+      offset_type readSome(char* dest, offset_type off, offset_type size) const;
+
+      /// Returns a pointer to the mapped range [off, off+size) or 0 if the
+      /// file is not mapped or the range is not contiguous in memory.
+      const char* data(offset_type off, offset_type size) const
+        { return mmapFile ? mmapFile->data(off, size) : 0; }
+
+      /// Returns the number of bytes mapped contiguously at off.
+      offset_type contiguousSize(offset_type off) const
+        { return mmapFile ? mmapFile->contiguousSize(off) : 0; }
+
+      /// Returns the mapping of the file or 0 if the file is not mapped.
+      MMapFile* getMMapFile() const   { return const_cast<MMapFile*>(mmapFile.getPointer()); }
+
+      offset_type fsize() const
+        { return parts.empty() ? 0 : parts.back().offset + parts.back().size; }
+      time_t getMTime() const   { return mtime; }
+      std::vector<std::string> getFilenames() const;
+  };
+
+  /**
+     Streambuf, which reads sequentially from a FileReader starting at a
+     given offset.
+
+     The streambuf is meant to be instantiated for each read operation, so
+     that threads do not share any position or buffer. Mapped data is
+     passed to the reader without copying.
+   */
+  class FileReaderStreamBuf : public std::streambuf
+  {
+      const FileReader& reader;
+      offset_type pos;
+      unsigned bufsize;
+      std::vector<char> buffer;   // allocated on first read, which is not mapped
+
+      int_type underflow();
+
+    public:
+      FileReaderStreamBuf(const FileReader& reader_, offset_type pos_, unsigned bufsize_)
+        : reader(reader_),
+          pos(pos_),
+          bufsize(bufsize_)
+        { }
+  };
+
+  class FileReaderStream : public std::istream
+  {
+      FileReaderStreamBuf streambuf;
+
+    public:
+      FileReaderStream(const FileReader& reader, offset_type pos, unsigned bufsize = 8192)
+        : std::istream(0),
+          streambuf(reader, pos, bufsize)
+        { init(&streambuf); }
+  };
+
+}
+
+#endif // ZIM_FILEREADER_H
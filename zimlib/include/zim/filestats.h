@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_FILESTATS_H
+#define ZIM_FILESTATS_H
+
+#include <zim/zim.h>
+
+namespace zim
+{
+  /**
+     Snapshot of the performance counters of a zim file.
+
+     The counters start at 0, when the file is opened, and never decrease,
+     so they may be exported as counters into monitoring systems. They are
+     always enabled: they are incremented under the locks, which are taken
+     anyway, or with atomic operations. bufferPoolBytes is no counter but
+     the current size of the pool.
+   */
+  struct FileStats
+  {
+    enum { compressionTypes = zimcompLzma + 1 };
+
+    uint64_t direntCacheHits;
+    uint64_t direntCacheMisses;
+    uint64_t direntCacheEvictions;
+
+    uint64_t clusterCacheHits;
+    uint64_t clusterCacheMisses;
+    uint64_t clusterCacheEvictions;
+
+    /// bytes of directory entries read from the file
+    uint64_t direntBytesRead;
+    /// bytes of clusters read from the file indexed by their CompressionType
+    uint64_t clusterBytesRead[compressionTypes];
+
+    uint64_t clustersDecompressed;
+    uint64_t decompressMicroseconds;
+
+    /// number of lookups by url and by title
+    uint64_t urlLookups;
+    uint64_t titleLookups;
+    /// steps of the binary searches and probes of the url index for lookups
+    uint64_t lookupSteps;
+
+    /// bytes of freed cluster buffers currently kept by the process wide
+    /// BufferPool; they are not part of the cluster cache budget
+    uint64_t bufferPoolBytes;
+
+    FileStats()
+      : direntCacheHits(0),
+        direntCacheMisses(0),
+        direntCacheEvictions(0),
+        clusterCacheHits(0),
+        clusterCacheMisses(0),
+        clusterCacheEvictions(0),
+        direntBytesRead(0),
+        clustersDecompressed(0),
+        decompressMicroseconds(0),
+        urlLookups(0),
+        titleLookups(0),
+        lookupSteps(0),
+        bufferPoolBytes(0)
+    {
+      for (unsigned c = 0; c < compressionTypes; ++c)
+        clusterBytesRead[c] = 0;
+    }
+
+    /// returns the bytes of clusters read from the file
+    uint64_t getClusterBytesRead() const
+    {
+      uint64_t ret = 0;
+      for (unsigned c = 0; c < compressionTypes; ++c)
+        ret += clusterBytesRead[c];
+      return ret;
+    }
+  };
+
+}
+
+#endif // ZIM_FILESTATS_H
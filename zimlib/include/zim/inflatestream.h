@@ -23,7 +23,9 @@
 
 #include <iostream>
 #include <stdexcept>
+#include <cstddef>
 #include <zlib.h>
+#include <zim/bufferpool.h>
 
 namespace zim
 {
@@ -42,7 +44,12 @@ namespace zim
 
   class InflateStreamBuf : public std::streambuf
   {
-      z_stream stream;
+    public:
+      struct Decoder;   // pooled decoder state and buffer
+
+    private:
+      Decoder* decoder;
+      z_stream& stream;
       char_type* iobuffer;
       unsigned bufsize;
       std::streambuf* sinksource;
@@ -87,6 +94,11 @@ namespace zim
       void setSource(std::istream& source)             { streambuf.setSinksource(source.rdbuf()); }
       uLong getAdler() const   { return streambuf.getAdler(); }
   };
+
+  /// Decompresses the zlib stream in [data, data+size) into out, which is
+  /// resized to the uncompressed size. When the uncompressed size is known,
+  /// it is passed as sizeHint, so that out is allocated just once.
+  void inflateBuffer(const char* data, std::size_t size, Buffer& out, std::size_t sizeHint = 0);
 }
 
 #endif // ZIM_INFLATESTREAM_H
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_LATENCYHISTOGRAM_H
+#define ZIM_LATENCYHISTOGRAM_H
+
+#include <zim/zim.h>
+#include <zim/noncopyable.h>
+
+namespace zim
+{
+  /**
+     A histogram of latencies in the style of HdrHistogram.
+
+     Values below 128 are counted exactly. Larger values are counted in
+     buckets, which split each power of 2 into 64 sub buckets, so that
+     percentiles are accurate to within 1.6% of the value. Values of 2^40
+     and above (about 18 minutes in nanoseconds) are counted in the last
+     bucket. The histogram has a fixed size of about 18k.
+
+     Recording uses atomic operations only, so it is thread safe and does
+     not block. Reading while other threads record returns approximate
+     results.
+   */
+  class LatencyHistogram : private NonCopyable
+  {
+    public:
+      enum {
+        subBucketBits = 6,
+        subBucketCount = 1 << subBucketBits,
+        maxValueBits = 40,
+        bucketCount = 2 * subBucketCount + (maxValueBits - subBucketBits - 1) * subBucketCount
+      };
+
+    private:
+      volatile uint64_t counts[bucketCount];
+      volatile uint64_t count;
+      volatile uint64_t sum;
+      volatile uint64_t min;
+      volatile uint64_t max;
+
+    public:
+      LatencyHistogram()
+        { clear(); }
+
+      /// counts a value
+      void record(uint64_t value);
+
+      /// adds the values of another histogram
+      void add(const LatencyHistogram& h);
+
+      /// resets the histogram
+      void clear();
+
+      uint64_t getCount() const   { return count; }
+      /// returns the smallest value or 0, if the histogram is empty
+      uint64_t getMin() const     { return count > 0 ? min : 0; }
+      uint64_t getMax() const     { return max; }
+      double getMean() const
+        { return count > 0 ? static_cast<double>(sum) / static_cast<double>(count) : 0; }
+
+      /// Returns the value, which is greater or equal than percentile percent
+      /// (0 to 100) of the values, i.e. the highest value of its bucket
+      /// but at most the maximum. Returns 0, if the histogram is empty.
+      uint64_t getPercentile(double percentile) const;
+
+      /// returns the number of values counted in the bucket
+      uint64_t getBucketCount(unsigned bucket) const  { return counts[bucket]; }
+
+      /// returns the index of the bucket, where the value is counted
+      static unsigned bucketIndex(uint64_t value);
+      /// returns the lowest value counted in the bucket
+      static uint64_t bucketLow(unsigned bucket);
+      /// returns the highest value counted in the bucket
+      static uint64_t bucketHigh(unsigned bucket);
+  };
+
+}
+
+#endif // ZIM_LATENCYHISTOGRAM_H
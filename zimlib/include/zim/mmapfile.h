@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_MMAPFILE_H
+#define ZIM_MMAPFILE_H
+
+#include <string>
+#include <vector>
+#include <zim/zim.h>
+#include <zim/refcounted.h>
+
+namespace zim
+{
+  /**
+     Maps a zim file read only into memory.
+
+     A zim file may be split into several parts (foo.zimaa, foo.zimab, ...).
+     Each part is mapped separately, so a range of the file is only
+     accessible as a pointer, when it does not cross the boundary of a part.
+
+     The class is reference counted, so that objects pointing into the
+     mapping (e.g. blobs of uncompressed clusters) can keep it alive after
+     the file is closed.
+   */
+  class MMapFile : public RefCounted
+  {
+      struct Part
+      {
+        offset_type offset;
+        offset_type size;
+        char* data;
+      };
+
+      typedef std::vector<Part> Parts;
+      Parts parts;
+
+      const Part* findPart(offset_type off) const;
+
+    public:
+      explicit MMapFile(const std::vector<std::string>& fnames);
+      ~MMapFile();
+
+      /// Returns a pointer to the range [off, off+size) of the file or 0,
+      /// if the range is not mapped contiguously.
+      const char* data(offset_type off, offset_type size) const;
+
+      /// Returns the number of bytes, which are mapped contiguously starting
+      /// at offset off.
+      offset_type contiguousSize(offset_type off) const;
+
+      offset_type fsize() const;
+  };
+
+}
+
+#endif // ZIM_MMAPFILE_H
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_MUTEX_H
+#define ZIM_MUTEX_H
+
+#include <zim/noncopyable.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#undef NOMINMAX
+#undef max
+#else
+#include <pthread.h>
+#endif
+
+namespace zim
+{
+  class Condition;
+
+  class Mutex : private NonCopyable
+  {
+      friend class Condition;
+
+#ifdef _WIN32
+      CRITICAL_SECTION mutex;
+
+    public:
+      Mutex()        { ::InitializeCriticalSection(&mutex); }
+      ~Mutex()       { ::DeleteCriticalSection(&mutex); }
+
+      void lock()    { ::EnterCriticalSection(&mutex); }
+      void unlock()  { ::LeaveCriticalSection(&mutex); }
+#else
+      pthread_mutex_t mutex;
+
+    public:
+      Mutex()        { ::pthread_mutex_init(&mutex, 0); }
+      ~Mutex()       { ::pthread_mutex_destroy(&mutex); }
+
+      void lock()    { ::pthread_mutex_lock(&mutex); }
+      void unlock()  { ::pthread_mutex_unlock(&mutex); }
+#endif
+  };
+
+  /// Condition variable, which is waited on with a locked mutex.
+  class Condition : private NonCopyable
+  {
+#ifdef _WIN32
+      CONDITION_VARIABLE cond;
+
+    public:
+      Condition()        { ::InitializeConditionVariable(&cond); }
+
+      void wait(Mutex& mutex)  { ::SleepConditionVariableCS(&cond, &mutex.mutex, INFINITE); }
+      void signal()      { ::WakeConditionVariable(&cond); }
+      void broadcast()   { ::WakeAllConditionVariable(&cond); }
+#else
+      pthread_cond_t cond;
+
+    public:
+      Condition()        { ::pthread_cond_init(&cond, 0); }
+      ~Condition()       { ::pthread_cond_destroy(&cond); }
+
+      void wait(Mutex& mutex)  { ::pthread_cond_wait(&cond, &mutex.mutex); }
+      void signal()      { ::pthread_cond_signal(&cond); }
+      void broadcast()   { ::pthread_cond_broadcast(&cond); }
+#endif
+  };
+
+  /// Locks a mutex for the lifetime of the object.
+  class MutexLock : private NonCopyable
+  {
+      Mutex& mutex;
+
+    public:
+      explicit MutexLock(Mutex& mutex_)
+        : mutex(mutex_)
+        { mutex.lock(); }
+
+      ~MutexLock()
+        { mutex.unlock(); }
+  };
+
+}
+
+#endif // ZIM_MUTEX_H
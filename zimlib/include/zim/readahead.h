@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_READAHEAD_H
+#define ZIM_READAHEAD_H
+
+#include <deque>
+#include <zim/zim.h>
+#include <zim/cluster.h>
+#include <zim/mutex.h>
+#include <zim/thread.h>
+#include <zim/atomic.h>
+
+namespace zim
+{
+  class FileImpl;
+
+  /**
+     Reads clusters ahead of a sequential scan in a background thread.
+
+     Each access to a cluster is reported with access(). When the clusters
+     are accessed in ascending order, the next clusters up to the configured
+     depth are queued and loaded into the cluster cache by the thread. When
+     a reader needs a cluster, which is just being loaded, it waits for the
+     thread instead of loading it again. A access out of order cancels the
+     queued clusters.
+
+     The thread is started on first use.
+   */
+  class ClusterReadahead : private Thread
+  {
+      FileImpl& file;
+
+      Mutex mutex;
+      Condition workCond;   // signals the thread, that there is work or it should stop
+      Condition doneCond;   // signals waiting readers, that a cluster is loaded
+
+      std::deque<size_type> queue;
+      mutable volatile unsigned depth;  // tested without the mutex, so accessed atomically
+      size_type last;       // the last accessed cluster
+      size_type next;       // the cluster after the last queued one
+      size_type current;    // the cluster, which is currently loaded
+      size_type doneIdx;    // the cluster, which was loaded last
+      Cluster done;
+      bool stop;
+
+      void run();
+
+    public:
+      static const size_type npos = 0xffffffff;
+
+      explicit ClusterReadahead(FileImpl& file);
+      ~ClusterReadahead();
+
+      /// Sets the number of clusters to read ahead; 0 disables readahead.
+      void setDepth(unsigned depth);
+      unsigned getDepth() const  { return atomicGet(depth); }
+
+      /// Notifies, that the cluster idx is accessed and queues the next
+      /// clusters on sequential access.
+      void access(size_type idx);
+
+      /// Removes all queued clusters.
+      void cancel();
+
+      /// Returns the cluster idx, when it is just loaded by the thread. If
+      /// it is not loaded or not yet started, an empty cluster is returned,
+      /// so that the caller loads it itself.
+      Cluster wait(size_type idx);
+  };
+
+}
+
+#endif // ZIM_READAHEAD_H
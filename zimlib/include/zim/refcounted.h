@@ -30,12 +30,15 @@
 #define ZIM_REFCOUNTED_H
 
 #include <zim/noncopyable.h>
+#include <zim/atomic.h>
 
 namespace zim
 {
+  /// Reference counted base class. The reference counter is updated
+  /// atomically, so objects may be shared between threads.
   class RefCounted : private NonCopyable
   {
-      unsigned rc;
+      volatile unsigned rc;
 
     public:
       RefCounted()
@@ -48,8 +51,8 @@ namespace zim
 
       virtual ~RefCounted()  { }
 
-      virtual unsigned addRef()  { return ++rc; }
-      virtual void release()     { if (--rc == 0) delete this; }
+      virtual unsigned addRef()  { return atomicIncrement(rc); }
+      virtual void release()     { if (atomicDecrement(rc) == 0) delete this; }
       unsigned refs() const   { return rc; }
   };
 
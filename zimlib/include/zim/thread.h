@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_THREAD_H
+#define ZIM_THREAD_H
+
+#include <zim/noncopyable.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#undef NOMINMAX
+#undef max
+#else
+#include <pthread.h>
+#endif
+
+namespace zim
+{
+  /**
+     Base class for a thread. The derived class implements run(), which is
+     executed in the thread after start() is called. The thread must be
+     joined before the object is destroyed.
+   */
+  class Thread : private NonCopyable
+  {
+#ifdef _WIN32
+      HANDLE handle;
+      static DWORD WINAPI exec(void* arg);
+#else
+      pthread_t thread;
+      static void* exec(void* arg);
+#endif
+
+      bool started;
+
+    protected:
+      virtual void run() = 0;
+
+    public:
+      Thread()
+        : started(false)
+        { }
+      virtual ~Thread()  { }
+
+      /// Starts the thread. Throws std::runtime_error, if the thread could
+      /// not be created.
+      void start();
+
+      /// Waits for the thread to finish. Does nothing, if it was not started.
+      void join();
+
+      bool isStarted() const   { return started; }
+  };
+
+}
+
+#endif // ZIM_THREAD_H
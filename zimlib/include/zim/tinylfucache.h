@@ -0,0 +1,484 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_TINYLFUCACHE_H
+#define ZIM_TINYLFUCACHE_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+#include <zim/zim.h>
+#include <zim/noncopyable.h>
+#include <zim/cache.h>
+#include <zim/cachelist.h>
+
+namespace zim
+{
+  /**
+     Estimates the access frequency of keys in little memory.
+
+     The sketch is a count-min sketch with 4 bit counters. Each key is
+     counted in 4 of 16 counters per expected key, which are selected by
+     its hash, and the estimate is the minimum of them. When the number
+     of increments reaches 10 times the number of counters, all counters
+     are halved, so that the frequencies of keys, which are no longer
+     accessed, decay.
+   */
+  class FrequencySketch
+  {
+      std::vector<uint64_t> table;   // 16 counters per word
+      std::size_t additions;
+
+      std::size_t _counters() const   { return table.size() * 16; }
+
+      std::size_t _index(uint64_t h, unsigned i) const
+      {
+        uint64_t h2 = ((h >> 32) ^ (h * 0x9e3779b9u)) | 1;
+        return static_cast<std::size_t>(h + i * h2) & (_counters() - 1);
+      }
+
+      unsigned _get(std::size_t idx) const
+        { return static_cast<unsigned>(table[idx >> 4] >> ((idx & 15) * 4)) & 15; }
+
+      void _reset()
+      {
+        uint64_t mask = (static_cast<uint64_t>(0x77777777) << 32) | 0x77777777;
+        for (std::vector<uint64_t>::iterator it = table.begin(); it != table.end(); ++it)
+          *it = (*it >> 1) & mask;
+        additions /= 2;
+      }
+
+    public:
+      FrequencySketch()
+        : table(1),
+          additions(0)
+        { }
+
+      /// Makes the sketch large enough for n keys. The counters are
+      /// cleared, when the sketch grows.
+      void ensureCapacity(std::size_t n)
+      {
+        // 16 counters per key
+        std::size_t words = 1;
+        while (words < n && words < (static_cast<std::size_t>(1) << 24))
+          words *= 2;
+
+        if (words > table.size())
+        {
+          std::vector<uint64_t>(words).swap(table);
+          additions = 0;
+        }
+      }
+
+      /// returns the estimated frequency of the key with the hash h (0-15)
+      unsigned frequency(uint64_t h) const
+      {
+        unsigned ret = 15;
+        for (unsigned i = 0; i < 4; ++i)
+        {
+          unsigned c = _get(_index(h, i));
+          if (c < ret)
+            ret = c;
+        }
+        return ret;
+      }
+
+      /// Counts an access to the key with the hash h. Only the smallest of
+      /// the counters of the key are incremented (conservative update),
+      /// which reduces the overestimation by collisions.
+      void increment(uint64_t h)
+      {
+        unsigned f = frequency(h);
+        if (f >= 15)
+          return;
+
+        for (unsigned i = 0; i < 4; ++i)
+        {
+          std::size_t idx = _index(h, i);
+          if (_get(idx) == f)
+            table[idx >> 4] += static_cast<uint64_t>(1) << ((idx & 15) * 4);
+        }
+
+        if (++additions >= _counters() * 10)
+          _reset();
+      }
+
+      void clear()
+      {
+        std::fill(table.begin(), table.end(), 0);
+        additions = 0;
+      }
+
+      /// returns the number of bytes used by the counters
+      std::size_t getMemorySize() const
+        { return table.size() * sizeof(uint64_t); }
+  };
+
+  /**
+     Cache with W-TinyLFU admission.
+
+     The interface is the same as of Cache. New elements are put into a
+     small window, which takes 1% of the cache. Elements pushed out of the
+     window are admitted to the main part only, when they were accessed
+     more often than the element, which would be dropped for them. The
+     access frequencies are estimated using a FrequencySketch, which counts
+     every get, whether the element is found or not, so that it remembers
+     elements, which are no longer in the cache.
+
+     The main part is a segmented LRU: admitted elements are put into the
+     probation segment and move to the protected segment, which takes 80%
+     of the main part, when they are found again. Elements dropped from the
+     protected segment go back to the probation segment.
+
+     This makes the cache resistant against scans, where many elements are
+     accessed just once, and keeps frequently used elements even if they
+     were not used recently.
+   */
+  template <typename Key, typename Value, typename Hash = CacheHash<Key> >
+  class TinyLfuCache : private NonCopyable
+  {
+    public:
+      typedef std::size_t size_type;
+      typedef Value value_type;
+
+    private:
+      enum Segment { segWindow, segProbation, segProtected };
+
+      struct Node
+      {
+        Key key;
+        Value value;
+        size_type cost;
+        Segment segment;
+        Node* hashNext;
+        Node* prev;   // newer element
+        Node* next;   // older element
+
+        Node(const Key& key_, const Value& value_, size_type cost_, Segment segment_)
+          : key(key_),
+            value(value_),
+            cost(cost_),
+            segment(segment_),
+            hashNext(0),
+            prev(0),
+            next(0)
+            { }
+      };
+
+      typedef CacheList<Node> List;
+
+      CacheTable<Node, Key, Hash> table;
+      List segments[3];
+      FrequencySketch sketch;
+
+      size_type maxElements;
+      size_type maxCost;
+      size_type peakCost;
+      uint64_t hits;
+      uint64_t misses;
+      uint64_t evictions;
+
+      // the window takes 1% and the protected segment 80% of the rest
+      size_type _windowElements() const   { return maxElements / 100 + 1; }
+      size_type _windowCost() const       { return maxCost / 100; }
+
+      size_type _protectedElements() const
+      {
+        size_type m = maxElements > _windowElements() ? maxElements - _windowElements() : 0;
+        return m - m / 5;
+      }
+
+      size_type _protectedCost() const
+      {
+        size_type m = maxCost - _windowCost();
+        return m - m / 5;
+      }
+
+      bool _overflow() const
+        { return size() > maxElements || (maxCost > 0 && getCost() > maxCost); }
+
+      bool _windowOverflow() const
+      {
+        const List& l = segments[segWindow];
+        return l.count > 1
+            && (l.count > _windowElements() || (maxCost > 0 && l.cost > _windowCost()));
+      }
+
+      bool _protectedOverflow() const
+      {
+        const List& l = segments[segProtected];
+        return l.count > 0
+            && (l.count > _protectedElements() || (maxCost > 0 && l.cost > _protectedCost()));
+      }
+
+      // The sketch is sized once for the maximum number of elements, so
+      // that the counters are not lost while the cache fills. Caches
+      // limited by cost have no useful maximum, so the size is capped.
+      void _sizeSketch()
+        { sketch.ensureCapacity(std::min(maxElements, static_cast<size_type>(16384))); }
+
+      unsigned _frequency(const Node* n) const
+        { return sketch.frequency(table.hashOf(n->key)); }
+
+      void _move(Node* n, Segment segment)
+      {
+        segments[n->segment].unlink(n);
+        n->segment = segment;
+        segments[segment].pushNewest(n);
+      }
+
+      void _remove(Node* n)
+      {
+        table.remove(n);
+        segments[n->segment].unlink(n);
+        delete n;
+      }
+
+      void _touch(Node* n)
+      {
+        if (n->segment == segWindow)
+          _move(n, segWindow);
+        else
+        {
+          _move(n, segProtected);
+          while (_protectedOverflow())
+            _move(segments[segProtected].oldest, segProbation);
+        }
+      }
+
+      // Moves the overflow of the window to the probation segment and drops
+      // elements, until the cache does not overflow. The elements from the
+      // window are the candidates, which are compared with the oldest
+      // elements of the probation segment.
+      void _evict()
+      {
+        while (_protectedOverflow())
+          _move(segments[segProtected].oldest, segProbation);
+
+        Node* candidate = 0;   // the oldest candidate
+        while (_windowOverflow())
+        {
+          Node* n = segments[segWindow].oldest;
+          _move(n, segProbation);
+          if (candidate == 0)
+            candidate = n;
+        }
+
+        while (_overflow())
+        {
+          Node* victim = segments[segProbation].oldest ? segments[segProbation].oldest
+                       : segments[segProtected].oldest ? segments[segProtected].oldest
+                       : segments[segWindow].oldest;
+
+          if (candidate == 0 || candidate == victim)
+          {
+            if (candidate)
+              candidate = candidate->prev;
+            _remove(victim);
+          }
+          else if (_frequency(candidate) > _frequency(victim))
+            _remove(victim);
+          else
+          {
+            Node* next = candidate->prev;
+            _remove(candidate);
+            candidate = next;
+          }
+
+          ++evictions;
+        }
+      }
+
+      void _put(const Key& key, const Value& value, size_type cost, bool top)
+      {
+        if (maxElements == 0 || (maxCost > 0 && cost > maxCost))
+        {
+          // the element does not fit into the cache at all
+          erase(key);
+          return;
+        }
+
+        Node* n = table.find(key);
+        if (n)
+        {
+          List& l = segments[n->segment];
+          l.cost -= n->cost;
+          n->value = value;
+          n->cost = cost;
+          l.cost += n->cost;
+          _touch(n);
+        }
+        else
+        {
+          n = new Node(key, value, cost, top ? segProtected : segWindow);
+          table.insert(n);
+          segments[n->segment].pushNewest(n);
+        }
+
+        if (getCost() > peakCost)
+          peakCost = getCost();
+
+        _evict();
+      }
+
+    public:
+      explicit TinyLfuCache(size_type maxElements_, size_type maxCost_ = 0)
+        : maxElements(maxElements_),
+          maxCost(maxCost_),
+          peakCost(0),
+          hits(0),
+          misses(0),
+          evictions(0)
+        { _sizeSketch(); }
+
+      ~TinyLfuCache()
+        { clear(); }
+
+      /// returns the number of elements currently in the cache
+      size_type size() const
+        { return segments[segWindow].count + segments[segProbation].count + segments[segProtected].count; }
+
+      /// returns the maximum number of elements in the cache
+      size_type getMaxElements() const      { return maxElements; }
+
+      void setMaxElements(size_type maxElements_)
+      {
+        maxElements = maxElements_;
+        _sizeSketch();
+        _evict();
+      }
+
+      /// returns the sum of the costs of the elements in the cache
+      size_type getCost() const
+        { return segments[segWindow].cost + segments[segProbation].cost + segments[segProtected].cost; }
+
+      /// returns the highest cost held in the cache since the last reset of
+      /// the statistics
+      size_type getPeakCost() const { return peakCost; }
+
+      /// returns the maximum cost of the cache or 0 if not limited
+      size_type getMaxCost() const  { return maxCost; }
+
+      void setMaxCost(size_type maxCost_)
+      {
+        maxCost = maxCost_;
+        _evict();
+      }
+
+      /// returns the estimated number of bytes used for managing the
+      /// elements, i.e. the hash table, the list nodes and the sketch
+      size_type getOverhead() const
+      {
+        return table.bucketCount() * sizeof(Node*) + size() * sizeof(Node)
+             + sketch.getMemorySize();
+      }
+
+      /// removes a element from the cache and returns true, if found
+      bool erase(const Key& key)
+      {
+        Node* n = table.find(key);
+        if (n == 0)
+          return false;
+
+        _remove(n);
+        return true;
+      }
+
+      /// clears the cache and the frequencies.
+      void clear(bool stats = false)
+      {
+        table.clear();
+        for (unsigned s = 0; s < 3; ++s)
+          segments[s] = List();
+        sketch.clear();
+
+        if (stats)
+          hits = misses = evictions = peakCost = 0;
+      }
+
+      /// puts a new element into the window of the cache. If the element is
+      /// already found in the cache, its value is replaced.
+      void put(const Key& key, const Value& value, size_type cost = 1)
+        { _put(key, value, cost, false); }
+
+      /// puts a new element directly into the protected segment, bypassing
+      /// the admission.
+      void put_top(const Key& key, const Value& value, size_type cost = 1)
+        { _put(key, value, cost, true); }
+
+      /// returns true, if the key is found; this is neither counted as a hit
+      /// or miss nor as an access of the key
+      bool contains(const Key& key)
+        { return table.find(key) != 0; }
+
+      Value* getptr(const Key& key)
+      {
+        sketch.increment(table.hashOf(key));
+
+        Node* n = table.find(key);
+        if (n == 0)
+        {
+          ++misses;
+          return 0;
+        }
+
+        ++hits;
+        _touch(n);
+        return &n->value;
+      }
+
+      /// returns a pair of values - a flag, if the value was found and the
+      /// value if found or the passed default otherwise.
+      std::pair<bool, Value> getx(const Key& key, Value def = Value())
+      {
+        Value* v = getptr(key);
+        return v ? std::pair<bool, Value>(true, *v)
+                 : std::pair<bool, Value>(false, def);
+      }
+
+      /// returns the value to a key or the passed default value if not found.
+      Value get(const Key& key, Value def = Value())
+      {
+        return getx(key, def).second;
+      }
+
+      /// returns the number of hits.
+      uint64_t getHits() const    { return hits; }
+      /// returns the number of misses.
+      uint64_t getMisses() const  { return misses; }
+      /// returns the number of elements dropped, because the cache was full.
+      uint64_t getEvictions() const { return evictions; }
+      /// returns the cache hit ratio between 0 and 1.
+      double hitRatio() const     { return hits+misses > 0 ? static_cast<double>(hits)/static_cast<double>(hits+misses) : 0; }
+      /// returns the ratio, between held elements and maximum elements or
+      /// the ratio between the cost and the maximum cost, if set.
+      double fillfactor() const
+      {
+        return maxCost > 0     ? static_cast<double>(getCost()) / static_cast<double>(maxCost)
+             : maxElements > 0 ? static_cast<double>(size()) / static_cast<double>(maxElements)
+             : 0;
+      }
+
+  };
+
+}
+
+#endif // ZIM_TINYLFUCACHE_H
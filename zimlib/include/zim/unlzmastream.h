@@ -23,7 +23,9 @@
 
 #include <iostream>
 #include <stdexcept>
+#include <cstddef>
 #include <lzma.h>
+#include <zim/bufferpool.h>
 
 namespace zim
 {
@@ -42,7 +44,12 @@ namespace zim
 
   class UnlzmaStreamBuf : public std::streambuf
   {
-      lzma_stream stream;
+    public:
+      struct Decoder;   // pooled decoder state and buffer
+
+    private:
+      Decoder* decoder;
+      lzma_stream& stream;
       char_type* iobuffer;
       unsigned bufsize;
       std::streambuf* sinksource;
@@ -85,6 +92,11 @@ namespace zim
       void setSink(std::ostream& sink)                 { streambuf.setSinksource(sink.rdbuf()); }
       void setSource(std::istream& source)             { streambuf.setSinksource(source.rdbuf()); }
   };
+
+  /// Decompresses the lzma stream in [data, data+size) into out, which is
+  /// resized to the uncompressed size. When the uncompressed size is known,
+  /// it is passed as sizeHint, so that out is allocated just once.
+  void unlzmaBuffer(const char* data, std::size_t size, Buffer& out, std::size_t sizeHint = 0);
 }
 
 #endif // ZIM_UNLZMASTREAM_H
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_URLINDEX_H
+#define ZIM_URLINDEX_H
+
+#include <string>
+#include <vector>
+#include <zim/zim.h>
+#include <zim/uuid.h>
+#include <zim/filereader.h>
+#include <zim/noncopyable.h>
+
+namespace zim
+{
+  /**
+     Hash index for looking up articles by namespace and url.
+
+     The index is an open addressing hash table with linear probing. Each
+     slot holds 32 bits of the hash of the url and the article index. A
+     lookup returns the articles with matching hash bits, so the caller
+     needs to verify the url by reading the dirent, which usually is just
+     one read.
+
+     The table can be written to a file and read back. The file is mapped
+     if possible, so that it is not copied. It is tied to the zim file
+     by its uuid and article count. Its slots are checked, when it is
+     read, so that a damaged file is ignored like a missing one.
+
+     File format (little endian):
+       8 bytes magic "ZIMURLIX", 4 bytes version, 4 bytes number of slots,
+       4 bytes article count, 4 bytes reserved, 16 bytes uuid of the zim
+       file, then for each slot 4 bytes hash and 4 bytes article index.
+   */
+  class UrlIndex : private NonCopyable
+  {
+      std::vector<char> data;
+      FileReader* file;   // the mapped index file
+      const char* table;
+      size_type slots;
+
+      size_type getIdx(size_type slot) const;
+      uint32_t getHash(size_type slot) const;
+
+    public:
+      static const size_type npos = 0xffffffff;
+
+      UrlIndex()
+        : file(0),
+          table(0),
+          slots(0)
+        { }
+
+      ~UrlIndex()
+        { delete file; }
+
+      /// calculates the hash of a url
+      static uint64_t hash(char ns, const std::string& url);
+
+      /// creates an empty table for count articles
+      void init(size_type count);
+
+      /// adds a article index with the hash of its url
+      void insert(uint64_t h, size_type idx);
+
+      /// Reads the index from the file fname. Returns false, if the file
+      /// does not exist or does not match the zim file.
+      bool read(const std::string& fname, const Uuid& uuid, size_type count);
+
+      /// Writes the index to the file fname. The file is written to a
+      /// temporary file first and renamed.
+      void write(const std::string& fname, const Uuid& uuid, size_type count) const;
+
+      /// Returns the next article index with the hash h and advances probe,
+      /// which is 0 on the first call. Returns npos, if there are no more
+      /// candidates.
+      size_type lookup(uint64_t h, unsigned& probe) const;
+
+      bool empty() const   { return slots == 0; }
+  };
+
+}
+
+#endif // ZIM_URLINDEX_H
@@ -41,12 +41,14 @@ namespace zim
 
       private:
         unsigned minChunkSize;
+        bool withClusterInfo;
 
         Fileheader header;
 
         DirentsType dirents;
         SizeVectorType titleIdx;
         OffsetsType clusterOffsets;
+        SizeVectorType clusterInfo;   // uncompressed size and blob count of each cluster
         MimeTypes mimeTypes;
         RMimeTypes rmimeTypes;
         uint16_t nextMimeIdx;
@@ -63,7 +65,8 @@ namespace zim
         size_type clusterCount() const        { return clusterOffsets.size(); }
         size_type articleCount() const        { return dirents.size(); }
         offset_type mimeListSize() const;
-        offset_type mimeListPos() const       { return Fileheader::size; }
+        offset_type headerSize() const        { return withClusterInfo ? Fileheader::clusterInfoSize : Fileheader::size; }
+        offset_type mimeListPos() const       { return headerSize(); }
         offset_type urlPtrSize() const        { return articleCount() * sizeof(offset_type); }
         offset_type urlPtrPos() const         { return mimeListPos() + mimeListSize(); }
         offset_type titleIdxSize() const      { return articleCount() * sizeof(size_type); }
@@ -72,7 +75,9 @@ namespace zim
         offset_type indexPos() const          { return titleIdxPos() + titleIdxSize(); }
         offset_type clusterPtrSize() const    { return clusterCount() * sizeof(offset_type); }
         offset_type clusterPtrPos() const     { return indexPos() + indexSize(); }
-        offset_type checksumPos() const       { return clusterPtrPos() + clusterPtrSize() + clustersSize; }
+        offset_type clusterInfoSize() const   { return withClusterInfo ? clusterCount() * 2 * sizeof(size_type) : 0; }
+        offset_type clusterInfoPos() const    { return clusterPtrPos() + clusterPtrSize(); }
+        offset_type checksumPos() const       { return clusterInfoPos() + clusterInfoSize() + clustersSize; }
 
         uint16_t getMimeTypeIdx(const std::string& mimeType);
         const std::string& getMimeType(uint16_t mimeTypeIdx) const;
@@ -84,6 +89,15 @@ namespace zim
         unsigned getMinChunkSize()    { return minChunkSize; }
         void setMinChunkSize(int s)   { minChunkSize = s; }
 
+        CompressionType getCompression() const  { return compression; }
+        void setCompression(CompressionType c)  { compression = c; }
+
+        /* The cluster info table is an extension of the file format,
+         * which readers not knowing it may reject. It is not written
+         * unless enabled here or with the option `--cluster-info`. */
+        bool getClusterInfo() const   { return withClusterInfo; }
+        void setClusterInfo(bool sw)  { withClusterInfo = sw; }
+
         void create(const std::string& fname, ArticleSource& src);
 
         /* The user can query `currentSize` after each article has been
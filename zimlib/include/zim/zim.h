@@ -123,6 +123,21 @@ namespace zim
     zimcompLzma
   };
 
+  /// flags for opening a zim file, which may be or'ed together
+  enum OpenFlags
+  {
+    zimopenDefault = 0,
+    /// load the url pointer list, the title index and the cluster pointer
+    /// list into memory (or reference them in the mapped file) when opening
+    zimopenPreload = 1,
+    /// parse all directory entries into memory when opening, so that
+    /// lookups by url and title need no I/O
+    zimopenResident = 2,
+    /// use a hash index for looking up urls; the index is read from the
+    /// file <zimfile>.urlidx or created and written there
+    zimopenUrlIndex = 4
+  };
+
   static const char MimeHtmlTemplate[] = "text/x-zim-htmltemplate";
 }
 
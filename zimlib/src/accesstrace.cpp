@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include <zim/accesstrace.h>
+#include <zim/fileobserver.h>
+#include <zim/endian.h>
+#include <stdexcept>
+#include <stdlib.h>
+#include "log.h"
+
+log_define("zim.trace")
+
+namespace zim
+{
+  namespace
+  {
+    const char magic[] = "ZIMTRACE";
+    const unsigned magicSize = 8;
+
+    // records are written, when the buffer exceeds this size
+    const unsigned bufferSize = 64 * 1024;
+
+    void put(std::vector<char>& buffer, uint64_t v, unsigned n)
+    {
+      for (unsigned i = 0; i < n; ++i, v >>= 8)
+        buffer.push_back(static_cast<char>(v & 0xff));
+    }
+
+    uint64_t get(const char*& p, unsigned n)
+    {
+      uint64_t v = 0;
+      for (unsigned i = 0; i < n; ++i)
+        v |= static_cast<uint64_t>(static_cast<unsigned char>(p[i])) << (i * 8);
+      p += n;
+      return v;
+    }
+  }
+
+  void AccessTrace::open(const std::string& filename_)
+  {
+    close();
+
+    MutexLock lock(mutex);
+    out.clear();
+    out.open(filename_.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+      throw std::runtime_error("cannot open trace file " + filename_);
+
+    out.write(magic, magicSize);
+    buffer.reserve(bufferSize + TraceRecord::size);
+    filename = filename_;
+    start = now();
+    active = true;
+
+    log_info("trace accesses into " << filename_);
+  }
+
+  void AccessTrace::close()
+  {
+    MutexLock lock(mutex);
+    if (!active)
+      return;
+
+    active = false;
+    _flush();
+    out.close();
+  }
+
+  void AccessTrace::flush()
+  {
+    MutexLock lock(mutex);
+    if (active)
+      _flush();
+  }
+
+  void AccessTrace::_flush()
+  {
+    if (!buffer.empty())
+    {
+      out.write(&buffer[0], buffer.size());
+      buffer.clear();
+    }
+
+    if (!out)
+    {
+      log_error("error writing trace file; trace stopped");
+      active = false;
+    }
+  }
+
+  unsigned AccessTrace::addFile(const Uuid& uuid)
+  {
+    MutexLock lock(mutex);
+
+    // the number is stored in 8 bits
+    unsigned file = files++ & 0xff;
+
+    const char* u = uuid.data;
+    _record(file, traceOpen,
+            fromLittleEndian(reinterpret_cast<const size_type*>(u)), false,
+            fromLittleEndian(reinterpret_cast<const size_type*>(u + 4)),
+            fromLittleEndian(reinterpret_cast<const size_type*>(u + 8)),
+            fromLittleEndian(reinterpret_cast<const size_type*>(u + 12)),
+            zimcompNone);
+
+    log_debug("trace accesses of " << uuid << " as file " << file);
+    return file;
+  }
+
+  void AccessTrace::record(unsigned file, TraceKind kind, size_type idx, bool hit,
+                           size_type bytes, size_type memBytes, size_type usecs,
+                           CompressionType compression)
+  {
+    MutexLock lock(mutex);
+    _record(file, kind, idx, hit, bytes, memBytes, usecs, compression);
+  }
+
+  void AccessTrace::_record(unsigned file, TraceKind kind, size_type idx, bool hit,
+                            size_type bytes, size_type memBytes, size_type usecs,
+                            CompressionType compression)
+  {
+    if (!active)
+      return;
+
+    uint64_t t = now();
+
+    put(buffer, t > start ? t - start : 0, 8);
+    put(buffer, idx, 4);
+    put(buffer, bytes, 4);
+    put(buffer, memBytes, 4);
+    put(buffer, usecs, 4);
+    put(buffer, kind, 1);
+    put(buffer, hit ? 1 : 0, 1);
+    put(buffer, compression, 1);
+    put(buffer, file, 1);
+
+    if (buffer.size() >= bufferSize)
+      _flush();
+  }
+
+  namespace
+  {
+    void flushInstance()
+    {
+      AccessTrace::getInstance().flush();
+    }
+  }
+
+  AccessTrace* AccessTrace::createInstance()
+  {
+    AccessTrace* trace = new AccessTrace();
+    ::atexit(flushInstance);
+
+    const char* traceFile = ::getenv("ZIM_TRACE");
+    if (traceFile && *traceFile)
+    {
+      try
+      {
+        trace->open(traceFile);
+      }
+      catch (const std::exception& e)
+      {
+        log_error(e.what());
+      }
+    }
+
+    return trace;
+  }
+
+  AccessTrace& AccessTrace::getInstance()
+  {
+    // never destroyed, so that files destroyed at exit may still use it
+    static AccessTrace* instance = createInstance();
+    return *instance;
+  }
+
+  uint64_t AccessTrace::now()
+  {
+    return FileObserver::now() / 1000;
+  }
+
+  TraceReader::TraceReader(const std::string& filename)
+    : in(filename.c_str(), std::ios::in | std::ios::binary)
+  {
+    char m[magicSize];
+    if (!in.read(m, magicSize))
+      throw std::runtime_error("cannot read trace file " + filename);
+    if (std::string(m, magicSize) != magic)
+      throw std::runtime_error("invalid trace file " + filename);
+  }
+
+  bool TraceReader::next(TraceRecord& r)
+  {
+    char data[TraceRecord::size];
+    if (!in.read(data, TraceRecord::size))
+      return false;
+
+    const char* p = data;
+    r.time = get(p, 8);
+    r.idx = static_cast<size_type>(get(p, 4));
+    r.bytes = static_cast<size_type>(get(p, 4));
+    r.memBytes = static_cast<size_type>(get(p, 4));
+    r.usecs = static_cast<size_type>(get(p, 4));
+    r.kind = static_cast<TraceKind>(get(p, 1));
+    r.hit = get(p, 1) != 0;
+    r.compression = static_cast<CompressionType>(get(p, 1));
+    r.file = static_cast<unsigned>(get(p, 1));
+    return true;
+  }
+}
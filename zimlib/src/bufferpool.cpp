@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include <zim/bufferpool.h>
+#include "envvalue.h"
+#include "log.h"
+#include "config.h"
+#include <new>
+#include <cstring>
+#include <stdlib.h>
+
+#ifdef HAVE_MADVISE
+#include <sys/mman.h>
+#endif
+
+log_define("zim.bufferpool")
+
+namespace zim
+{
+  namespace
+  {
+    const std::size_t minSize = 4096;
+    const std::size_t hugePageSize = 2 * 1024 * 1024;
+  }
+
+  BufferPool::BufferPool()
+    : pooledBytes(0),
+      maxPooledBytes(envMemSize("ZIM_BUFFERPOOL", 8 * 1024 * 1024)),
+      hugePages(envValue("ZIM_HUGEPAGES", 0) != 0)
+  {
+  }
+
+  BufferPool& BufferPool::getInstance()
+  {
+    // never destroyed, so that buffers may be released by static objects
+    // destroyed at exit
+    static BufferPool* instance = new BufferPool();
+    return *instance;
+  }
+
+  std::size_t BufferPool::classSize(std::size_t size) const
+  {
+    if (size <= minSize)
+      return minSize;
+
+    std::size_t p = minSize;
+    while (p * 2 < size)
+      p *= 2;
+
+    std::size_t step = p / 4;
+    size = (size + step - 1) / step * step;
+
+    if (hugePages && size >= hugePageSize)
+      size = (size + hugePageSize - 1) / hugePageSize * hugePageSize;
+
+    return size;
+  }
+
+  char* BufferPool::allocSystem(std::size_t size)
+  {
+#if defined(HAVE_POSIX_MEMALIGN) && defined(HAVE_MADVISE) && defined(MADV_HUGEPAGE)
+    if (hugePages && size >= hugePageSize)
+    {
+      void* p;
+      if (::posix_memalign(&p, hugePageSize, size) != 0)
+        throw std::bad_alloc();
+      if (::madvise(p, size, MADV_HUGEPAGE) != 0)
+      {
+        log_debug("madvise(MADV_HUGEPAGE) failed");
+      }
+      return static_cast<char*>(p);
+    }
+#endif
+
+    void* p = ::malloc(size);
+    if (p == 0)
+      throw std::bad_alloc();
+    return static_cast<char*>(p);
+  }
+
+  char* BufferPool::allocate(std::size_t& size)
+  {
+    size = classSize(size);
+
+    {
+      MutexLock lock(mutex);
+      FreeLists::iterator it = freeLists.find(size);
+      if (it != freeLists.end() && !it->second.empty())
+      {
+        char* p = it->second.back();
+        it->second.pop_back();
+        pooledBytes -= size;
+        return p;
+      }
+    }
+
+    return allocSystem(size);
+  }
+
+  void BufferPool::release(char* p, std::size_t size)
+  {
+    if (p == 0)
+      return;
+
+    {
+      MutexLock lock(mutex);
+      if (pooledBytes + size <= maxPooledBytes)
+      {
+        freeLists[size].push_back(p);
+        pooledBytes += size;
+        return;
+      }
+    }
+
+    ::free(p);
+  }
+
+  void BufferPool::purge()
+  {
+    FreeLists l;
+
+    {
+      MutexLock lock(mutex);
+      l.swap(freeLists);
+      pooledBytes = 0;
+    }
+
+    log_debug("purge buffer pool");
+    for (FreeLists::iterator it = l.begin(); it != l.end(); ++it)
+      for (FreeList::iterator p = it->second.begin(); p != it->second.end(); ++p)
+        ::free(*p);
+  }
+
+  std::size_t BufferPool::getPooledBytes()
+  {
+    MutexLock lock(mutex);
+    return pooledBytes;
+  }
+
+  void Buffer::reserve(std::size_t n)
+  {
+    if (n <= bufcapacity)
+      return;
+
+    BufferPool& pool = BufferPool::getInstance();
+    std::size_t c = n;
+    char* p = pool.allocate(c);
+    if (bufsize > 0)
+      std::memcpy(p, ptr, bufsize);
+    pool.release(ptr, bufcapacity);
+    ptr = p;
+    bufcapacity = c;
+  }
+
+  void Buffer::assign(const char* begin, const char* end)
+  {
+    std::size_t n = end - begin;
+    bufsize = 0;
+    resize(n);
+    if (n > 0)
+      std::memcpy(ptr, begin, n);
+  }
+
+  void Buffer::clear()
+  {
+    if (ptr)
+      BufferPool::getInstance().release(ptr, bufcapacity);
+    ptr = 0;
+    bufsize = 0;
+    bufcapacity = 0;
+  }
+
+}
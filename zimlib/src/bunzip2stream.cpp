@@ -22,6 +22,9 @@
 #include <sstream>
 #include <cstring>
 #include <algorithm>
+#include <vector>
+#include <cstdlib>
+#include "decoderpool.h"
 
 log_define("zim.bzip2.uncompress")
 
@@ -48,20 +51,113 @@ namespace zim
     { return a <= b ? a : b; }
   }
 
+  /*
+     bzip2 has no way to reset a decompressor, so the decoder is initialized
+     for each stream. The memory blocks freed by bzip2 are kept in the
+     decoder, so that the next stream gets them instead of allocating new
+     ones.
+   */
+  struct Bunzip2StreamBuf::Decoder
+  {
+    typedef std::vector<std::pair<std::size_t, void*> > Blocks;
+
+    bz_stream stream;
+    std::vector<char> buffer;
+    Blocks blocks;
+
+    ~Decoder()
+    {
+      for (Blocks::iterator it = blocks.begin(); it != blocks.end(); ++it)
+        std::free(static_cast<std::size_t*>(it->second) - 1);
+    }
+
+    static void* alloc(void* opaque, int n, int m);
+    static void free(void* opaque, void* p);
+  };
+
+  void* Bunzip2StreamBuf::Decoder::alloc(void* opaque, int n, int m)
+  {
+    Decoder* decoder = static_cast<Decoder*>(opaque);
+    std::size_t size = static_cast<std::size_t>(n) * m;
+
+    for (Blocks::iterator it = decoder->blocks.begin(); it != decoder->blocks.end(); ++it)
+    {
+      if (it->first == size)
+      {
+        void* p = it->second;
+        decoder->blocks.erase(it);
+        return p;
+      }
+    }
+
+    void* p = std::malloc(size + sizeof(std::size_t));
+    if (p == 0)
+      return 0;
+
+    // the size is stored in front of the block, so that it is known on free
+    *static_cast<std::size_t*>(p) = size;
+    return static_cast<std::size_t*>(p) + 1;
+  }
+
+  void Bunzip2StreamBuf::Decoder::free(void* opaque, void* p)
+  {
+    if (p == 0)
+      return;
+
+    Decoder* decoder = static_cast<Decoder*>(opaque);
+    std::size_t* b = static_cast<std::size_t*>(p) - 1;
+    decoder->blocks.push_back(Blocks::value_type(*b, p));
+  }
+
+  namespace
+  {
+    DecoderPool<Bunzip2StreamBuf::Decoder>& decoderPool()
+      { return DecoderPool<Bunzip2StreamBuf::Decoder>::getInstance(); }
+
+    Bunzip2StreamBuf::Decoder* getDecoder(unsigned bufsize)
+    {
+      Bunzip2StreamBuf::Decoder* decoder = decoderPool().get();
+      if (decoder == 0)
+        decoder = new Bunzip2StreamBuf::Decoder();
+      if (decoder->buffer.size() < bufsize)
+        decoder->buffer.resize(bufsize);
+      return decoder;
+    }
+
+    void initDecoder(Bunzip2StreamBuf::Decoder* decoder, bool small)
+    {
+      bz_stream& stream = decoder->stream;
+      std::memset(&stream, 0, sizeof(bz_stream));
+      stream.bzalloc = Bunzip2StreamBuf::Decoder::alloc;
+      stream.bzfree = Bunzip2StreamBuf::Decoder::free;
+      stream.opaque = decoder;
+
+      checkError(::BZ2_bzDecompressInit(&stream, 0, static_cast<int>(small)), stream);
+    }
+  }
+
   Bunzip2StreamBuf::Bunzip2StreamBuf(std::streambuf* sinksource_, bool small, unsigned bufsize_)
-    : iobuffer(new char_type[bufsize_]),
+    : decoder(getDecoder(bufsize_)),
+      stream(decoder->stream),
+      iobuffer(&decoder->buffer[0]),
       bufsize(bufsize_),
       sinksource(sinksource_)
   {
-    std::memset(&stream, 0, sizeof(bz_stream));
-
-    checkError(::BZ2_bzDecompressInit(&stream, 0, static_cast<int>(small)), stream);
+    try
+    {
+      initDecoder(decoder, small);
+    }
+    catch (...)
+    {
+      decoderPool().put(decoder);
+      throw;
+    }
   }
 
   Bunzip2StreamBuf::~Bunzip2StreamBuf()
   {
     ::BZ2_bzDecompressEnd(&stream);
-    delete[] iobuffer;
+    decoderPool().put(decoder);
   }
 
   Bunzip2StreamBuf::int_type Bunzip2StreamBuf::overflow(int_type c)
@@ -142,6 +238,60 @@ namespace zim
     return sgetc();
   }
 
+  void bunzip2Buffer(const char* data, std::size_t size, Buffer& out, std::size_t sizeHint)
+  {
+    Bunzip2StreamBuf::Decoder* decoder = getDecoder(0);
+    bz_stream& stream = decoder->stream;
+
+    try
+    {
+      initDecoder(decoder, false);
+    }
+    catch (...)
+    {
+      decoderPool().put(decoder);
+      throw;
+    }
+
+    try
+    {
+      stream.next_in = const_cast<char*>(data);
+      stream.avail_in = size;
+
+      out.resize(initialOutputSize(size, sizeHint));
+      std::size_t count = 0;
+      while (true)
+      {
+        if (count == out.size())
+          out.resize(out.size() * 2);
+
+        stream.next_out = &out[count];
+        stream.avail_out = out.size() - count;
+
+        int ret = checkError(::BZ2_bzDecompress(&stream), stream);
+
+        count = out.size() - stream.avail_out;
+
+        if (ret == BZ_STREAM_END)
+          break;
+
+        if (stream.avail_in == 0 && stream.avail_out > 0)
+          throw Bzip2UncompressError(BZ_UNEXPECTED_EOF, "bzip2-error: unexpected end of compressed data");
+      }
+
+      out.resize(count);
+    }
+    catch (...)
+    {
+      ::BZ2_bzDecompressEnd(&stream);
+      decoderPool().put(decoder);
+      throw;
+    }
+
+    ::BZ2_bzDecompressEnd(&stream);
+    decoderPool().put(decoder);
+  }
+
   int Bunzip2StreamBuf::sync()
   {
     if (pptr() && overflow(traits_type::eof()) == traits_type::eof())
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include <zim/cachepolicy.h>
+#include <stdexcept>
+
+namespace zim
+{
+  CachePolicy getCachePolicy(const std::string& name)
+  {
+    if (name == "winnerlooser" || name == "default")
+      return cachePolicyWinnerLooser;
+    if (name == "tinylfu")
+      return cachePolicyTinyLfu;
+    if (name == "arc")
+      return cachePolicyArc;
+    throw std::runtime_error("unknown cache policy \"" + name + '"');
+  }
+
+  const char* getCachePolicyName(CachePolicy policy)
+  {
+    switch (policy)
+    {
+      case cachePolicyTinyLfu: return "tinylfu";
+      case cachePolicyArc:     return "arc";
+      default:                 return "winnerlooser";
+    }
+  }
+}
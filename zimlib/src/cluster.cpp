@@ -21,6 +21,7 @@
 #include <zim/blob.h>
 #include <zim/endian.h>
 #include <stdlib.h>
+#include <cstring>
 #include <sstream>
 
 #include "log.h"
@@ -60,7 +61,8 @@ namespace zim
   }
 
   ClusterImpl::ClusterImpl()
-    : compression(zimcompNone)
+    : compression(zimcompNone),
+      extData(0)
   {
     offsets.push_back(0);
   }
@@ -85,6 +87,9 @@ namespace zim
     // read offsets
     offsets.clear();
     data.clear();
+    buffer.clear();
+    extData = 0;
+    extDataOwner = 0;
     offsets.reserve(n);
     offsets.push_back(0);
     while (--n)
@@ -106,15 +111,158 @@ namespace zim
       n = offsets.back() - offsets.front();
       if (n > 0)
       {
-        data.resize(n);
+        buffer.resize(n);
         log_debug1("read " << n << " bytes of data");
-        in.read(&(data[0]), n);
+        in.read(buffer.data(), n);
+        extData = buffer.data();
       }
       else
         log_warn("read empty cluster");
     }
   }
 
+  namespace
+  {
+    // reads an offset; the offsets are not aligned in mapped files and
+    // buffers
+    size_type readOffset(const char* ptr)
+    {
+      size_type offset;
+      std::memcpy(&offset, ptr, sizeof(offset));
+      return fromLittleEndian(&offset);
+    }
+  }
+
+  size_type ClusterImpl::parseOffsets(const char* ptr, offset_type size)
+  {
+    if (size < sizeof(size_type))
+      return 0;
+
+    // the first offset specifies, how many offsets we have
+    size_type a = readOffset(ptr);
+    size_type n = a / 4;
+
+    if (n == 0 || a > size)
+      return 0;
+
+    offsets.clear();
+    offsets.reserve(n);
+    offsets.push_back(0);
+    size_type last = a;
+    for (size_type i = 1; i < n; ++i)
+    {
+      size_type offset = readOffset(ptr + i * sizeof(size_type));
+      if (offset < last || offset > size)
+        return 0;
+      offsets.push_back(offset - a);
+      last = offset;
+    }
+
+    return a;
+  }
+
+  bool ClusterImpl::readMapped(const char* ptr, offset_type size, RefCounted* owner)
+  {
+    log_debug1("readMapped");
+
+    data.clear();
+    buffer.clear();
+    size_type a = parseOffsets(ptr, size);
+    if (a == 0)
+      return false;
+
+    extData = ptr + a;
+    extDataOwner = owner;
+
+    return true;
+  }
+
+  bool ClusterImpl::readBuffer(const char* ptr, offset_type size, size_type sizeHint)
+  {
+    log_debug1("readBuffer");
+
+    if (size < 1)
+      return false;
+
+    compression = static_cast<CompressionType>(*ptr);
+    ++ptr;
+    --size;
+
+    data.clear();
+    extData = 0;
+    extDataOwner = 0;
+
+    switch (compression)
+    {
+      case zimcompDefault:
+      case zimcompNone:
+        buffer.assign(ptr, ptr + size);
+        break;
+
+      case zimcompZip:
+#ifdef ENABLE_ZLIB
+        log_debug("uncompress data (zlib)");
+        inflateBuffer(ptr, size, buffer, sizeHint);
+#else
+        throw std::runtime_error("zlib not enabled in this library");
+#endif
+        break;
+
+      case zimcompBzip2:
+#ifdef ENABLE_BZIP2
+        log_debug("uncompress data (bzip2)");
+        bunzip2Buffer(ptr, size, buffer, sizeHint);
+#else
+        throw std::runtime_error("bzip2 not enabled in this library");
+#endif
+        break;
+
+      case zimcompLzma:
+#ifdef ENABLE_LZMA
+        log_debug("uncompress data (lzma)");
+        unlzmaBuffer(ptr, size, buffer, sizeHint);
+#else
+        throw std::runtime_error("lzma not enabled in this library");
+#endif
+        break;
+
+      default:
+        log_error("invalid compression flag " << static_cast<int>(compression));
+        return false;
+    }
+
+    size_type a = buffer.empty() ? 0 : parseOffsets(buffer.data(), buffer.size());
+    if (a == 0)
+    {
+      buffer.clear();
+      return false;
+    }
+
+    extData = buffer.data() + a;
+
+    return true;
+  }
+
+  void ClusterImpl::setMappedBlob(const char* ptr, size_type size, RefCounted* owner)
+  {
+    offsets.clear();
+    data.clear();
+    buffer.clear();
+    offsets.push_back(0);
+    offsets.push_back(size);
+    extData = ptr;
+    extDataOwner = owner;
+  }
+
+  char* ClusterImpl::appendBlob(size_type size)
+  {
+    size_type s = offsets.back();
+    buffer.resize(s + size);
+    offsets.push_back(s + size);
+    extData = buffer.data();
+    return extData ? buffer.data() + s : 0;
+  }
+
   void ClusterImpl::write(std::ostream& out) const
   {
     size_type a = offsets.size() * sizeof(size_type);
@@ -126,8 +274,9 @@ namespace zim
       out.write(reinterpret_cast<const char*>(&o), sizeof(size_type));
     }
 
-    if (data.size() > 0)
-      out.write(&(data[0]), data.size());
+    size_type n = offsets.back() - offsets.front();
+    if (n > 0)
+      out.write(getData(0), n);
     else
       log_warn("write empty cluster");
   }
@@ -150,6 +299,9 @@ namespace zim
   {
     offsets.clear();
     data.clear();
+    buffer.clear();
+    extData = 0;
+    extDataOwner = 0;
     offsets.push_back(0);
   }
 
@@ -251,7 +403,7 @@ namespace zim
           zim::DeflateStream os(out);
           os.exceptions(std::ios::failbit | std::ios::badbit);
           clusterImpl.write(os);
-          os.flush();
+          os.end();
 #else
           throw std::runtime_error("zlib not enabled in this library");
 #endif
@@ -0,0 +1,421 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include <zim/clusterdiskcache.h>
+#include <zim/filereader.h>
+#include <zim/endian.h>
+#include "envvalue.h"
+#include "log.h"
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+log_define("zim.cluster.disk")
+
+namespace zim
+{
+  namespace
+  {
+    const char magic[] = "ZIMCLUS2";
+    const unsigned headerSize = 29;
+    const char suffix[] = ".cluster";
+    const char tmpSuffix[] = ".tmp";
+
+    // temporary files of crashed processes are removed after an hour
+    const time_t tmpMaxAge = 3600;
+
+    // files are touched on read, when their time is older than this
+    const time_t touchInterval = 60;
+
+    struct CacheFile
+    {
+      std::string fname;
+      offset_type size;
+      time_t mtime;
+
+      bool operator< (const CacheFile& f) const
+        { return mtime < f.mtime; }
+    };
+
+    bool endsWith(const std::string& s, const char* e)
+    {
+      std::string::size_type n = std::strlen(e);
+      return s.size() >= n && s.compare(s.size() - n, n, e) == 0;
+    }
+
+#ifndef _WIN32
+    // Returns the size of the cluster files in dir and adds them to files.
+    // Stale temporary files are removed.
+    offset_type scanDir(const std::string& dir, std::vector<CacheFile>& files)
+    {
+      offset_type total = 0;
+
+      DIR* d = ::opendir(dir.c_str());
+      if (d == 0)
+      {
+        log_warn("cannot read cluster directory \"" << dir << "\": " << strerror(errno));
+        return 0;
+      }
+
+      time_t now = ::time(0);
+      struct dirent* e;
+      while ((e = ::readdir(d)) != 0)
+      {
+        std::string name = e->d_name;
+        bool tmp = name[0] == '.' && endsWith(name, tmpSuffix);
+        if (!tmp && !endsWith(name, suffix))
+          continue;
+
+        CacheFile f;
+        f.fname = dir + '/' + name;
+
+        struct stat st;
+        if (::stat(f.fname.c_str(), &st) != 0)
+          continue;
+
+        if (tmp)
+        {
+          if (st.st_mtime + tmpMaxAge < now)
+          {
+            log_debug("remove stale temporary file \"" << f.fname << '"');
+            std::remove(f.fname.c_str());
+          }
+          continue;
+        }
+
+        f.size = st.st_size;
+        f.mtime = st.st_mtime;
+        files.push_back(f);
+        total += f.size;
+      }
+
+      ::closedir(d);
+      return total;
+    }
+#endif
+  }
+
+  std::string ClusterDiskCache::path(size_type idx) const
+  {
+    std::ostringstream s;
+    s << dir << '/' << prefix << '-' << idx << suffix;
+    return s.str();
+  }
+
+  void ClusterDiskCache::open(const std::string& dir_, const Uuid& uuid, offset_type maxBytes_)
+  {
+#ifdef _WIN32
+    log_warn("cluster directory not supported on this platform");
+#else
+    if (::mkdir(dir_.c_str(), 0777) != 0 && errno != EEXIST)
+    {
+      log_warn("cannot create cluster directory \"" << dir_ << "\": " << strerror(errno));
+      return;
+    }
+
+    std::ostringstream s;
+    s << uuid;
+
+    dir = dir_;
+    prefix = s.str();
+    maxBytes = maxBytes_;
+    useMmap = envValue("ZIM_MMAP", 1) != 0;
+
+    // evicts, when the directory is already too large
+    evict();
+    log_debug("cluster directory \"" << dir << "\" holds " << bytes << " bytes");
+#endif
+  }
+
+  void ClusterDiskCache::evict()
+  {
+#ifndef _WIN32
+    // the directory is scanned without holding the lock, so that put()
+    // does not wait for it
+    std::vector<CacheFile> files;
+    offset_type total = scanDir(dir, files);
+    if (total > maxBytes)
+    {
+      std::sort(files.begin(), files.end());
+
+      offset_type limit = maxBytes / 4 * 3;
+      unsigned count = 0;
+      for (std::vector<CacheFile>::const_iterator it = files.begin(); it != files.end() && total > limit; ++it)
+      {
+        // files mapped by other processes stay valid after removal
+        if (std::remove(it->fname.c_str()) == 0)
+        {
+          total -= it->size;
+          ++count;
+        }
+      }
+
+      log_debug(count << " files removed from cluster directory \"" << dir << "\"; " << total << " bytes left");
+    }
+
+    MutexLock lock(mutex);
+    bytes = total;
+#endif
+  }
+
+  ClusterDiskCache::~ClusterDiskCache()
+  {
+    {
+      MutexLock lock(mutex);
+      stop = true;
+      workCond.signal();
+    }
+
+    join();
+  }
+
+  Cluster ClusterDiskCache::get(size_type idx, offset_type offset, offset_type size)
+  {
+    if (!enabled())
+      return Cluster();
+
+#ifndef _WIN32
+    std::string fname = path(idx);
+
+    // FileReader would look for split files, when the file does not exist
+    struct stat st;
+    if (::stat(fname.c_str(), &st) != 0 || st.st_size <= static_cast<off_t>(headerSize))
+      return Cluster();
+
+    try
+    {
+      FileReader f(fname);
+      offset_type dataSize = f.fsize() - headerSize;
+
+      char header[headerSize];
+      f.read(header, 0, headerSize);
+      if (std::memcmp(header, magic, 8) != 0
+        || fromLittleEndian(reinterpret_cast<const offset_type*>(header + 9)) != offset
+        || fromLittleEndian(reinterpret_cast<const offset_type*>(header + 17)) != size)
+      {
+        log_warn("cluster file \"" << fname << "\" does not match the zim file");
+        return Cluster();
+      }
+
+      size_type blobCount = fromLittleEndian(reinterpret_cast<const size_type*>(header + 25));
+
+      Cluster cluster;
+      bool ok;
+      const char* p = useMmap && f.map() ? f.data(headerSize, dataSize) : 0;
+      if (p && static_cast<CompressionType>(*p) == zimcompNone)
+      {
+        ok = cluster.readMapped(p + 1, dataSize - 1, f.getMMapFile());
+      }
+      else
+      {
+        std::vector<char> buffer(dataSize);
+        f.read(&buffer[0], headerSize, dataSize);
+        ok = cluster.readBuffer(&buffer[0], dataSize);
+      }
+
+      if (!ok || cluster.count() != blobCount)
+      {
+        log_warn("invalid cluster file \"" << fname << '"');
+        return Cluster();
+      }
+
+      // the cluster is cached like the one decompressed from the zim file
+      cluster.setCompression(static_cast<CompressionType>(header[8]));
+
+      // mark the file as recently used; the eviction does not need a finer
+      // resolution than a metadata write per minute
+      if (st.st_mtime + touchInterval < ::time(0))
+        ::utime(fname.c_str(), 0);
+
+      log_debug("cluster " << idx << " read from \"" << fname << '"');
+      return cluster;
+    }
+    catch (const std::exception& e)
+    {
+      log_warn("failed to read cluster file \"" << fname << "\": " << e.what());
+    }
+#endif
+
+    return Cluster();
+  }
+
+  void ClusterDiskCache::put(size_type idx, offset_type offset, offset_type size, const Cluster& cluster)
+  {
+    if (!enabled())
+      return;
+
+#ifndef _WIN32
+    Job job;
+    job.idx = idx;
+    job.offset = offset;
+    job.size = size;
+    job.cluster = cluster;
+
+    {
+      MutexLock lock(mutex);
+
+      if (queue.size() >= maxQueued)
+      {
+        log_debug("cluster directory busy; cluster " << idx << " not written");
+        return;
+      }
+
+      bool started = isStarted();
+      if (!started)
+      {
+        try
+        {
+          start();
+          started = true;
+        }
+        catch (const std::exception& e)
+        {
+          log_warn("cluster files are written synchronously: " << e.what());
+        }
+      }
+
+      if (started)
+      {
+        queue.push_back(job);
+        workCond.signal();
+        return;
+      }
+    }
+
+    write(job);
+#endif
+  }
+
+  void ClusterDiskCache::flush()
+  {
+    MutexLock lock(mutex);
+    while (!queue.empty() || writing)
+      idleCond.wait(mutex);
+  }
+
+  void ClusterDiskCache::run()
+  {
+    mutex.lock();
+
+    // the queued clusters are written before the thread stops
+    while (!stop || !queue.empty())
+    {
+      if (queue.empty())
+      {
+        workCond.wait(mutex);
+        continue;
+      }
+
+      Job job = queue.front();
+      queue.pop_front();
+      writing = true;
+
+      mutex.unlock();
+
+      try
+      {
+        write(job);
+      }
+      catch (const std::exception& e)
+      {
+        log_warn("failed to write cluster " << job.idx << ": " << e.what());
+      }
+
+      mutex.lock();
+
+      writing = false;
+      if (queue.empty())
+        idleCond.broadcast();
+    }
+
+    mutex.unlock();
+  }
+
+  void ClusterDiskCache::write(const Job& job)
+  {
+#ifndef _WIN32
+    size_type idx = job.idx;
+    const Cluster& cluster = job.cluster;
+    std::string fname = path(idx);
+
+    std::ostringstream s;
+    {
+      MutexLock lock(mutex);
+      s << dir << "/." << prefix << '-' << idx << '.' << ::getpid() << '.' << tmpCount++ << tmpSuffix;
+    }
+    std::string tmpname = s.str();
+
+    char header[headerSize];
+    std::memcpy(header, magic, 8);
+    header[8] = static_cast<char>(cluster.getCompression());
+    toLittleEndian(job.offset, header + 9);
+    toLittleEndian(job.size, header + 17);
+    toLittleEndian(static_cast<size_type>(cluster.count()), header + 25);
+
+    std::ofstream out(tmpname.c_str(), std::ios::out | std::ios::binary);
+    out.write(header, headerSize);
+    out.put(static_cast<char>(zimcompNone));
+    cluster.writeUncompressed(out);
+    out.close();
+
+    if (out.fail())
+    {
+      log_warn("failed to write cluster file \"" << tmpname << '"');
+      std::remove(tmpname.c_str());
+      return;
+    }
+
+    // the rename is atomic, so other processes see the complete file or none
+    if (std::rename(tmpname.c_str(), fname.c_str()) != 0)
+    {
+      log_warn("failed to rename cluster file to \"" << fname << "\": " << strerror(errno));
+      std::remove(tmpname.c_str());
+      return;
+    }
+
+    log_debug("cluster " << idx << " written to \"" << fname << '"');
+
+    bool full;
+    {
+      MutexLock lock(mutex);
+      bytes += headerSize + 1 + cluster.size();
+      full = bytes > maxBytes;
+    }
+
+    if (full)
+      evict();
+#endif
+  }
+
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_DECODERPOOL_H
+#define ZIM_DECODERPOOL_H
+
+#include <vector>
+#include <cstddef>
+#include <zim/mutex.h>
+#include <zim/noncopyable.h>
+#include "envvalue.h"
+
+namespace zim
+{
+  /// Returns the initial size of the output buffer for decompressing size
+  /// bytes. One byte more than the expected size is needed, so that the
+  /// decoder can see the end of the stream without growing the buffer.
+  inline std::size_t initialOutputSize(std::size_t size, std::size_t sizeHint)
+  {
+    return sizeHint > 0 ? sizeHint + 1
+         : size * 4 > 65536 ? size * 4
+         : 65536;
+  }
+
+  /**
+     Keeps unused decoder contexts, so that the allocations of a decoder
+     and its buffers are reused for the next cluster instead of being
+     freed. The number of kept decoders is limited by the environment
+     variable ZIM_DECODERPOOL (default 16).
+   */
+  template <typename Decoder>
+  class DecoderPool : private NonCopyable
+  {
+      Mutex mutex;
+      std::vector<Decoder*> decoders;
+      unsigned maxDecoders;
+
+    public:
+      DecoderPool()
+        : maxDecoders(envValue("ZIM_DECODERPOOL", 16))
+        { }
+
+      ~DecoderPool()
+      {
+        for (typename std::vector<Decoder*>::iterator it = decoders.begin(); it != decoders.end(); ++it)
+          delete *it;
+      }
+
+      static DecoderPool& getInstance()
+      {
+        // never destroyed, so that decoders may be returned by static
+        // objects destroyed at exit
+        static DecoderPool* instance = new DecoderPool();
+        return *instance;
+      }
+
+      /// returns a unused decoder or 0, if there is none
+      Decoder* get()
+      {
+        MutexLock lock(mutex);
+        if (decoders.empty())
+          return 0;
+        Decoder* decoder = decoders.back();
+        decoders.pop_back();
+        return decoder;
+      }
+
+      /// returns a decoder to the pool or deletes it, if the pool is full
+      void put(Decoder* decoder)
+      {
+        {
+          MutexLock lock(mutex);
+          if (decoders.size() < maxDecoders)
+          {
+            decoders.push_back(decoder);
+            return;
+          }
+        }
+
+        delete decoder;
+      }
+  };
+
+}
+
+#endif // ZIM_DECODERPOOL_H
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/decompresspool.h>
+#include <zim/fileimpl.h>
+#include <stdexcept>
+#include "log.h"
+
+log_define("zim.decompresspool")
+
+namespace zim
+{
+  void DecompressPool::Worker::run()
+  {
+    pool.work(number);
+  }
+
+  DecompressPool::DecompressPool(FileImpl& file_)
+    : file(file_),
+      threads(0),
+      stop(false)
+  { }
+
+  DecompressPool::~DecompressPool()
+  {
+    {
+      MutexLock lock(mutex);
+      stop = true;
+      workCond.broadcast();
+    }
+
+    for (std::vector<Worker*>::iterator it = workers.begin(); it != workers.end(); ++it)
+    {
+      (*it)->join();
+      delete *it;
+    }
+  }
+
+  void DecompressPool::setThreads(unsigned threads_)
+  {
+    MutexLock lock(mutex);
+    log_debug("set number of decompress threads to " << threads_);
+    threads = threads_;
+    if (!workers.empty())
+      startWorkers();
+    workCond.broadcast();
+  }
+
+  void DecompressPool::startWorkers()
+  {
+    // called with locked mutex
+    while (workers.size() < threads)
+    {
+      Worker* worker = new Worker(*this, workers.size());
+      try
+      {
+        worker->start();
+      }
+      catch (...)
+      {
+        delete worker;
+        throw;
+      }
+      workers.push_back(worker);
+    }
+  }
+
+  void DecompressPool::load(std::vector<Job>& jobs)
+  {
+    if (jobs.empty())
+      return;
+
+    if (threads > 0)
+    {
+      MutexLock lock(mutex);
+
+      try
+      {
+        startWorkers();
+      }
+      catch (const std::exception& e)
+      {
+        log_warn("failed to start decompress threads: " << e.what());
+        if (workers.empty())
+          threads = 0;
+      }
+
+      if (!workers.empty())
+      {
+        log_debug("load " << jobs.size() << " clusters with " << threads << " threads");
+
+        for (std::vector<Job>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+        {
+          while (queue.size() >= maxQueue())
+            spaceCond.wait(mutex);
+          queue.push_back(&*it);
+          workCond.broadcast();
+        }
+
+        for (std::vector<Job>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+          while (!it->done)
+            doneCond.wait(mutex);
+
+        return;
+      }
+    }
+
+    for (std::vector<Job>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+    {
+      it->cluster = file.readCluster(it->idx, file.getClusterOffset(it->idx));
+      it->done = true;
+    }
+  }
+
+  void DecompressPool::work(unsigned number)
+  {
+    mutex.lock();
+
+    while (true)
+    {
+      // workers above the configured number are kept idle, but when the
+      // pool is disabled, one worker finishes the queued jobs
+      while (!stop && (queue.empty() || number >= (threads > 0 ? threads : 1)))
+        workCond.wait(mutex);
+
+      if (queue.empty())
+        break;
+
+      Job* job = queue.front();
+      queue.pop_front();
+      spaceCond.signal();
+
+      mutex.unlock();
+
+      Cluster cluster;
+      std::string error;
+      try
+      {
+        cluster = file.readCluster(job->idx, file.getClusterOffset(job->idx));
+      }
+      catch (const std::exception& e)
+      {
+        error = e.what();
+      }
+
+      mutex.lock();
+
+      job->cluster = cluster;
+      job->error = error;
+      job->done = true;
+      doneCond.broadcast();
+    }
+
+    mutex.unlock();
+  }
+
+}
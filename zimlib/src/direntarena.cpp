@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/direntarena.h>
+#include "log.h"
+
+log_define("zim.direntarena")
+
+namespace zim
+{
+  void DirentArena::add(const Dirent& dirent)
+  {
+    Record r;
+    r.strOffset = strings.size();
+    r.version = dirent.getVersion();
+    r.clusterNumber = dirent.isRedirect() ? dirent.getRedirectIndex() : dirent.getClusterNumber();
+    r.blobNumber = dirent.getBlobNumber();
+    r.mimeType = dirent.getMimeType();
+    r.ns = dirent.getNamespace();
+
+    const std::string& url = dirent.getUrl();
+    const std::string& title = dirent.getTitle();
+    const std::string& parameter = dirent.getParameter();
+
+    r.urlSize = url.size();
+    r.titleSize = title == url ? 0 : title.size();
+    r.parameterSize = parameter.size();
+
+    strings.insert(strings.end(), url.begin(), url.end());
+    if (r.titleSize)
+      strings.insert(strings.end(), title.begin(), title.end());
+    strings.insert(strings.end(), parameter.begin(), parameter.end());
+
+    records.push_back(r);
+  }
+
+  Dirent DirentArena::getDirent(size_type idx) const
+  {
+    const Record& r = records[idx];
+
+    Dirent dirent;
+    dirent.setVersion(r.version);
+    if (r.mimeType == Dirent::redirectMimeType)
+      dirent.setRedirect(r.clusterNumber);
+    else
+      dirent.setArticle(r.mimeType, r.clusterNumber, r.blobNumber);
+
+    const char* p = url(r);
+    dirent.setUrl(r.ns, std::string(p, r.urlSize));
+    p += r.urlSize;
+    if (r.titleSize)
+    {
+      dirent.setTitle(std::string(p, r.titleSize));
+      p += r.titleSize;
+    }
+    if (r.parameterSize)
+      dirent.setParameter(std::string(p, r.parameterSize));
+
+    return dirent;
+  }
+
+  size_type DirentArena::getNamespaceBeginOffset(char ns) const
+  {
+    size_type lower = 0;
+    size_type upper = records.size();
+    while (lower < upper)
+    {
+      size_type m = lower + (upper - lower) / 2;
+      if (records[m].ns < ns)
+        lower = m + 1;
+      else
+        upper = m;
+    }
+    return lower;
+  }
+
+  size_type DirentArena::getNamespaceEndOffset(char ns) const
+  {
+    size_type lower = 0;
+    size_type upper = records.size();
+    while (lower < upper)
+    {
+      size_type m = lower + (upper - lower) / 2;
+      if (records[m].ns <= ns)
+        lower = m + 1;
+      else
+        upper = m;
+    }
+    return lower;
+  }
+
+  std::pair<bool, size_type> DirentArena::findx(char ns, const std::string& u) const
+  {
+    size_type lower = getNamespaceBeginOffset(ns);
+    size_type upper = getNamespaceEndOffset(ns);
+    if (lower == upper)
+    {
+      log_debug("namespace " << ns << " not found");
+      return std::pair<bool, size_type>(false, records.size());
+    }
+
+    while (lower < upper)
+    {
+      size_type m = lower + (upper - lower) / 2;
+      const Record& r = records[m];
+      int c = compare(ns, u, r.ns, url(r), r.urlSize);
+      if (c == 0)
+        return std::pair<bool, size_type>(true, m);
+      if (c > 0)
+        lower = m + 1;
+      else
+        upper = m;
+    }
+
+    log_debug("url " << ns << '/' << u << " not found");
+    return std::pair<bool, size_type>(false, lower);
+  }
+
+  std::pair<bool, size_type> DirentArena::findxByTitle(char ns, const std::string& t) const
+  {
+    // the namespaces have the same ranges in url and in title order
+    size_type lower = getNamespaceBeginOffset(ns);
+    size_type upper = getNamespaceEndOffset(ns);
+    if (lower == upper)
+    {
+      log_debug("namespace " << ns << " not found");
+      return std::pair<bool, size_type>(false, records.size());
+    }
+
+    while (lower < upper)
+    {
+      size_type m = lower + (upper - lower) / 2;
+      const Record& r = records[titleIdx[m]];
+      int c = compare(ns, t, r.ns, title(r), titleSize(r));
+      if (c == 0)
+        return std::pair<bool, size_type>(true, m);
+      if (c > 0)
+        lower = m + 1;
+      else
+        upper = m;
+    }
+
+    log_debug("title " << ns << '/' << t << " not found");
+    return std::pair<bool, size_type>(false, lower);
+  }
+
+}
@@ -17,7 +17,9 @@
  *
  */
 
+#include "envvalue.h"
 #include <sstream>
+#include <limits>
 #include <stdlib.h>
 
 namespace zim
@@ -33,7 +35,7 @@ namespace zim
     return def;
   }
 
-  unsigned envMemSize(const char* env, unsigned def)
+  uint64_t envMemSize64(const char* env, uint64_t def)
   {
     const char* v = ::getenv(env);
     if (v)
@@ -42,17 +44,29 @@ namespace zim
       std::istringstream s(v);
       s >> def >> unit;
 
+      uint64_t factor = 1;
       switch (unit)
       {
         case 'k':
-        case 'K': def *= 1024; break;
+        case 'K': factor = 1024; break;
         case 'm':
-        case 'M': def *= 1024 * 1024; break;
+        case 'M': factor = 1024 * 1024; break;
         case 'g':
-        case 'G': def *= 1024 * 1024 * 1024; break;
+        case 'G': factor = 1024 * 1024 * 1024; break;
       }
+
+      if (def > std::numeric_limits<uint64_t>::max() / factor)
+        def = std::numeric_limits<uint64_t>::max();
+      else
+        def *= factor;
     }
     return def;
   }
-}
 
+  unsigned envMemSize(const char* env, unsigned def)
+  {
+    uint64_t v = envMemSize64(env, def);
+    return v > std::numeric_limits<unsigned>::max() ? std::numeric_limits<unsigned>::max()
+                                                    : static_cast<unsigned>(v);
+  }
+}
@@ -20,10 +20,17 @@
 #ifndef ZIM_ENVVALUE_H
 #define ZIM_ENVVALUE_H
 
+#include <zim/zim.h>
+
 namespace zim
 {
   unsigned envValue(const char* env, unsigned def);
+
+  // Sizes may be followed by the unit k, M or G. envMemSize saturates at
+  // the maximum of unsigned; byte budgets, which may exceed 4G, use
+  // envMemSize64.
   unsigned envMemSize(const char* env, unsigned def);
+  uint64_t envMemSize64(const char* env, uint64_t def);
 }
 
 #endif // ZIM_ENVVALUE_H
@@ -39,6 +39,34 @@ namespace zim
         return ch - 'A' + 10;
       return -1;
     }
+
+    // counts a lookup with its steps in the statistics of the file and
+    // reports it to the observer of the file, when leaving the scope
+    class LookupCounter
+    {
+        FileImpl& impl;
+        bool byTitle;
+        OperationTimer timer;
+
+      public:
+        unsigned steps;
+
+        LookupCounter(FileImpl& impl_, bool byTitle_)
+          : impl(impl_),
+            byTitle(byTitle_),
+            timer(impl_.getObserver(), byTitle_ ? operationFindTitle : operationFindUrl),
+            steps(0)
+          { }
+
+        ~LookupCounter()
+          { impl.countLookup(byTitle, steps); }
+
+        std::pair<bool, File::const_iterator> result(bool found, const File::const_iterator& it)
+        {
+          timer.idx = it.getIndex();
+          return std::pair<bool, File::const_iterator>(found, it);
+        }
+    };
   }
 
   Article File::getArticle(size_type idx) const
@@ -67,6 +95,11 @@ namespace zim
     return Article(*this, impl->getIndexByTitle(idx));
   }
 
+  Article File::getArticleByClusterOrder(size_type idx)
+  {
+    return Article(*this, impl->getIndexByClusterOrder(idx));
+  }
+
   Article File::getArticleByTitle(char ns, const std::string& title)
   {
     log_trace("File::getArticleByTitle('" << ns << "', \"" << title << ')');
@@ -86,6 +119,9 @@ namespace zim
   File::const_iterator File::beginByTitle()
   { return const_iterator(this, 0, const_iterator::ArticleIterator); }
 
+  File::const_iterator File::beginByCluster()
+  { return const_iterator(this, 0, const_iterator::ClusterIterator); }
+
   File::const_iterator File::end()
   { return const_iterator(this, getCountArticles()); }
 
@@ -93,19 +129,48 @@ namespace zim
   {
     log_debug("find article by url " << ns << " \"" << url << "\",  in file \"" << getFilename() << '"');
 
+    LookupCounter lookup(*impl, false);
+
+    const UrlIndex* urlIndex = impl->getUrlIndex();
+    if (urlIndex)
+    {
+      uint64_t h = UrlIndex::hash(ns, url);
+      unsigned probe = 0;
+      size_type idx;
+      while ((idx = urlIndex->lookup(h, probe)) != UrlIndex::npos)
+      {
+        ++lookup.steps;
+        Dirent d = getDirent(idx);
+        if (d.getNamespace() == ns && d.getUrl() == url)
+        {
+          log_debug("article found using url index at index " << idx);
+          return lookup.result(true, const_iterator(this, idx));
+        }
+      }
+
+      // not found; the binary search below finds the position, where the
+      // url would be inserted
+    }
+
+    const DirentArena* arena = impl->getDirentArena();
+    if (arena)
+    {
+      std::pair<bool, size_type> r = arena->findx(ns, url);
+      return lookup.result(r.first, const_iterator(this, r.second));
+    }
+
     size_type l = getNamespaceBeginOffset(ns);
     size_type u = getNamespaceEndOffset(ns);
 
     if (l == u)
     {
       log_debug("namespace " << ns << " not found");
-      return std::pair<bool, const_iterator>(false, end());
+      return lookup.result(false, end());
     }
 
-    unsigned itcount = 0;
     while (u - l > 1)
     {
-      ++itcount;
+      ++lookup.steps;
       size_type p = l + (u - l) / 2;
       Dirent d = getDirent(p);
 
@@ -119,8 +184,8 @@ namespace zim
         l = p;
       else
       {
-        log_debug("article found after " << itcount << " iterations in file \"" << getFilename() << "\" at index " << p);
-        return std::pair<bool, const_iterator>(true, const_iterator(this, p));
+        log_debug("article found after " << lookup.steps << " iterations in file \"" << getFilename() << "\" at index " << p);
+        return lookup.result(true, const_iterator(this, p));
       }
     }
 
@@ -129,12 +194,12 @@ namespace zim
 
     if (c == 0)
     {
-      log_debug("article found after " << itcount << " iterations in file \"" << getFilename() << "\" at index " << l);
-      return std::pair<bool, const_iterator>(true, const_iterator(this, l));
+      log_debug("article found after " << lookup.steps << " iterations in file \"" << getFilename() << "\" at index " << l);
+      return lookup.result(true, const_iterator(this, l));
     }
 
-    log_debug("article not found after " << itcount << " iterations (\"" << d.getUrl() << "\" does not match)");
-    return std::pair<bool, const_iterator>(false, const_iterator(this, c < 0 ? l : u));
+    log_debug("article not found after " << lookup.steps << " iterations (\"" << d.getUrl() << "\" does not match)");
+    return lookup.result(false, const_iterator(this, c < 0 ? l : u));
   }
 
   std::pair<bool, File::const_iterator> File::findx(const std::string& url)
@@ -148,19 +213,27 @@ namespace zim
   {
     log_debug("find article by title " << ns << " \"" << title << "\", in file \"" << getFilename() << '"');
 
+    LookupCounter lookup(*impl, true);
+
+    const DirentArena* arena = impl->getDirentArena();
+    if (arena)
+    {
+      std::pair<bool, size_type> r = arena->findxByTitle(ns, title);
+      return lookup.result(r.first, const_iterator(this, r.second, const_iterator::ArticleIterator));
+    }
+
     size_type l = getNamespaceBeginOffset(ns);
     size_type u = getNamespaceEndOffset(ns);
 
     if (l == u)
     {
       log_debug("namespace " << ns << " not found");
-      return std::pair<bool, const_iterator>(false, end());
+      return lookup.result(false, end());
     }
 
-    unsigned itcount = 0;
     while (u - l > 1)
     {
-      ++itcount;
+      ++lookup.steps;
       size_type p = l + (u - l) / 2;
       Dirent d = getDirentByTitle(p);
 
@@ -174,8 +247,8 @@ namespace zim
         l = p;
       else
       {
-        log_debug("article found after " << itcount << " iterations in file \"" << getFilename() << "\" at index " << p);
-        return std::pair<bool, const_iterator>(true, const_iterator(this, p, const_iterator::ArticleIterator));
+        log_debug("article found after " << lookup.steps << " iterations in file \"" << getFilename() << "\" at index " << p);
+        return lookup.result(true, const_iterator(this, p, const_iterator::ArticleIterator));
       }
     }
 
@@ -184,12 +257,12 @@ namespace zim
 
     if (c == 0)
     {
-      log_debug("article found after " << itcount << " iterations in file \"" << getFilename() << "\" at index " << l);
-      return std::pair<bool, const_iterator>(true, const_iterator(this, l, const_iterator::ArticleIterator));
+      log_debug("article found after " << lookup.steps << " iterations in file \"" << getFilename() << "\" at index " << l);
+      return lookup.result(true, const_iterator(this, l, const_iterator::ArticleIterator));
     }
 
-    log_debug("article not found after " << itcount << " iterations (\"" << d.getTitle() << "\" does not match)");
-    return std::pair<bool, const_iterator>(false, const_iterator(this, c < 0 ? l : u, const_iterator::ArticleIterator));
+    log_debug("article not found after " << lookup.steps << " iterations (\"" << d.getTitle() << "\" does not match)");
+    return lookup.result(false, const_iterator(this, c < 0 ? l : u, const_iterator::ArticleIterator));
   }
 
   File::const_iterator File::find(char ns, const std::string& url)
@@ -29,12 +29,15 @@ namespace zim
   const size_type Fileheader::zimMagic = 0x044d495a; // ="ZIM^d"
   const size_type Fileheader::zimVersion = 5;
   const size_type Fileheader::size = 80;
+  const uint16_t Fileheader::clusterInfoMinorVersion = 1;
+  const size_type Fileheader::clusterInfoSize = 88;
 
   std::ostream& operator<< (std::ostream& out, const Fileheader& fh)
   {
-    char header[Fileheader::size];
+    char header[Fileheader::clusterInfoSize];
     toLittleEndian(Fileheader::zimMagic, header);
-    toLittleEndian(Fileheader::zimVersion, header + 4);
+    toLittleEndian(static_cast<uint16_t>(Fileheader::zimVersion), header + 4);
+    toLittleEndian(fh.getMinorVersion(), header + 6);
     std::copy(fh.getUuid().data, fh.getUuid().data + sizeof(Uuid), header + 8);
     toLittleEndian(fh.getArticleCount(), header + 24);
     toLittleEndian(fh.getClusterCount(), header + 28);
@@ -45,15 +48,17 @@ namespace zim
     toLittleEndian(fh.getMainPage(), header + 64);
     toLittleEndian(fh.getLayoutPage(), header + 68);
     toLittleEndian(fh.getChecksumPos(), header + 72);
+    toLittleEndian(fh.getClusterInfoPos(), header + 80);
 
-    out.write(header, Fileheader::size);
+    // headers of files without cluster info end before the pointer
+    out.write(header, fh.hasClusterInfo() ? Fileheader::clusterInfoSize : Fileheader::size);
 
     return out;
   }
 
   std::istream& operator>> (std::istream& in, Fileheader& fh)
   {
-    char header[Fileheader::size];
+    char header[Fileheader::clusterInfoSize];
     in.read(header, Fileheader::size);
     if (in.fail())
       return in;
@@ -81,6 +86,8 @@ namespace zim
       return in;
     }
 
+    uint16_t minorVersion = fromLittleEndian(reinterpret_cast<const uint16_t*>(header + 6));
+
     Uuid uuid;
     std::copy(header + 8, header + 24, uuid.data);
     size_type articleCount = fromLittleEndian(reinterpret_cast<const size_type*>(header + 24));
@@ -93,7 +100,20 @@ namespace zim
     size_type layoutPage = fromLittleEndian(reinterpret_cast<const size_type*>(header + 68));
     offset_type checksumPos = fromLittleEndian(reinterpret_cast<const offset_type*>(header + 72));
 
+    // the cluster info pointer follows in files of the cluster info minor
+    // version, when the header is large enough to hold it
+    offset_type clusterInfoPos = 0;
+    if (minorVersion >= Fileheader::clusterInfoMinorVersion
+      && mimeListPos >= Fileheader::clusterInfoSize)
+    {
+      in.read(header + Fileheader::size, Fileheader::clusterInfoSize - Fileheader::size);
+      if (in.fail())
+        return in;
+      clusterInfoPos = fromLittleEndian(reinterpret_cast<const offset_type*>(header + 80));
+    }
+
     fh.setUuid(uuid);
+    fh.setMinorVersion(minorVersion);
     fh.setArticleCount(articleCount);
     fh.setClusterCount(clusterCount);
     fh.setUrlPtrPos(urlPtrPos);
@@ -103,6 +123,7 @@ namespace zim
     fh.setMainPage(mainPage);
     fh.setLayoutPage(layoutPage);
     fh.setChecksumPos(checksumPos);
+    fh.setClusterInfoPos(clusterInfoPos);
 
     return in;
   }
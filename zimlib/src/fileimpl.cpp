@@ -21,11 +21,15 @@
 #include <zim/error.h>
 #include <zim/dirent.h>
 #include <zim/endian.h>
+#include <zim/bufferpool.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sstream>
 #include <errno.h>
 #include <cstring>
+#include <stdlib.h>
+#include <limits>
+#include <algorithm>
 #include "config.h"
 #include "log.h"
 #include "envvalue.h"
@@ -35,26 +39,134 @@ log_define("zim.file.impl")
 
 namespace zim
 {
+  namespace
+  {
+    struct BlobRequest
+    {
+      size_type clusterIdx;
+      size_type blobIdx;
+      std::vector<Blob>::size_type pos;
+
+      bool operator< (const BlobRequest& r) const
+        { return clusterIdx < r.clusterIdx
+            || (clusterIdx == r.clusterIdx && blobIdx < r.blobIdx); }
+    };
+
+    // byte budget of a cache, which is limited by the address space
+    std::size_t envCacheBytes(const char* env, std::size_t def)
+    {
+      uint64_t v = envMemSize64(env, def);
+      return v > std::numeric_limits<std::size_t>::max() ? std::numeric_limits<std::size_t>::max()
+                                                         : static_cast<std::size_t>(v);
+    }
+
+    // When the cluster cache is limited by bytes, the number of clusters is
+    // only limited if explicitly requested.
+    unsigned clusterCacheSize(std::size_t maxBytes)
+    {
+      return envValue("ZIM_CLUSTERCACHE",
+        maxBytes > 0 ? std::numeric_limits<unsigned>::max() : CLUSTER_CACHE_SIZE);
+    }
+
+    // reads the name of a cache policy from the environment
+    CachePolicy envCachePolicy(const char* env)
+    {
+      const char* v = ::getenv(env);
+      if (v == 0 || *v == '\0')
+        return cachePolicyWinnerLooser;
+
+      try
+      {
+        return getCachePolicy(v);
+      }
+      catch (const std::exception& e)
+      {
+        log_warn(e.what() << " in " << env);
+        return cachePolicyWinnerLooser;
+      }
+    }
+  }
+
   //////////////////////////////////////////////////////////////////////
   // FileImpl
   //
-  FileImpl::FileImpl(const char* fname)
+  FileImpl::FileImpl(const char* fname, int flags)
     : zimFile(fname),
-      direntCache(envValue("ZIM_DIRENTCACHE", DIRENT_CACHE_SIZE)),
-      clusterCache(envValue("ZIM_CLUSTERCACHE", CLUSTER_CACHE_SIZE))
+      direntCache(envValue("ZIM_DIRENTCACHE", DIRENT_CACHE_SIZE), 0, 0,
+                  envCachePolicy("ZIM_DIRENTCACHEPOLICY")),
+      clusterCache(clusterCacheSize(envCacheBytes("ZIM_CLUSTERCACHEBYTES", CLUSTER_CACHE_BYTES)),
+                   envCacheBytes("ZIM_CLUSTERCACHEBYTES", CLUSTER_CACHE_BYTES), 0,
+                   envCachePolicy("ZIM_CLUSTERCACHEPOLICY")),
+      rawClusterCache(std::numeric_limits<unsigned>::max(),
+                      envCacheBytes("ZIM_RAWCLUSTERCACHEBYTES", RAW_CLUSTER_CACHE_BYTES)),
+      trace(0),
+      traceFile(0),
+      observer(0),
+      direntBytesRead(0),
+      clustersDecompressed(0),
+      decompressMicroseconds(0),
+      urlLookups(0),
+      titleLookups(0),
+      lookupSteps(0),
+      urlPtrList(0),
+      clusterPtrList(0),
+      titleIdxList(0),
+      clusterInfoList(0),
+      decompressPool(*this),
+      readahead(*this)
   {
     log_trace("read file \"" << fname << '"');
 
-    if (!zimFile)
-      throw ZimFileFormatError(std::string("can't open zim-file \"") + fname + '"');
+    for (unsigned c = 0; c < FileStats::compressionTypes; ++c)
+      clusterBytesRead[c] = 0;
 
     filename = fname;
 
+    if (envValue("ZIM_MMAP", 1))
+      zimFile.map();
+
     // read header
-    zimFile >> header;
-    if (zimFile.fail())
+    FileReaderStream in(zimFile, 0, Fileheader::clusterInfoSize);
+    in >> header;
+    if (in.fail())
       throw ZimFileFormatError("error reading zim-file header");
 
+    const char* traceEnv = ::getenv("ZIM_TRACE");
+    if (traceEnv && *traceEnv && AccessTrace::getInstance().enabled())
+    {
+      trace = &AccessTrace::getInstance();
+      traceFile = trace->addFile(header.getUuid());
+    }
+
+    const char* clusterDir = ::getenv("ZIM_CLUSTERDIR");
+    if (clusterDir && *clusterDir)
+      clusterDiskCache.open(clusterDir, header.getUuid(),
+        envMemSize64("ZIM_CLUSTERDIRBYTES", 1024 * 1024 * 1024));
+
+    if (envValue("ZIM_PRELOAD", 0))
+      flags |= zimopenPreload;
+
+    if (envValue("ZIM_RESIDENT", 0))
+      flags |= zimopenResident;
+
+    if (flags & (zimopenPreload | zimopenResident))
+    {
+      urlPtrList = preload(urlPtrs, header.getUrlPtrPos(), getCountArticles());
+      titleIdxList = preload(titleIdx, header.getTitleIdxPos(), getCountArticles());
+      clusterPtrList = preload(clusterPtrs, header.getClusterPtrPos(), getCountClusters());
+      if (header.hasClusterInfo())
+        clusterInfoList = preload(clusterInfo, header.getClusterInfoPos(), getCountClusters() * 2);
+    }
+
+    if (flags & zimopenResident)
+      loadDirentArena();
+
+    if (envValue("ZIM_URLINDEX", 0))
+      flags |= zimopenUrlIndex;
+
+    if (flags & zimopenUrlIndex)
+      loadUrlIndex();
+
     if (getCountClusters() == 0)
       log_warn("no clusters found");
     else
@@ -69,13 +181,13 @@ namespace zim
     }
 
     // read mime types
-    zimFile.seekg(header.getMimeListPos());
+    FileReaderStream mimeIn(zimFile, header.getMimeListPos(), 1024);
     std::string mimeType;
     while (true)
     {
-      std::getline(zimFile, mimeType, '\0');
+      std::getline(mimeIn, mimeType, '\0');
 
-      if (zimFile.fail())
+      if (mimeIn.fail())
         throw ZimFileFormatError("error reading mime type list");
 
       if (mimeType.empty())
@@ -83,53 +195,202 @@ namespace zim
 
       mimeTypes.push_back(mimeType);;
     }
+
+    decompressPool.setThreads(envValue("ZIM_DECOMPRESSTHREADS", 0));
+    readahead.setDepth(envValue("ZIM_READAHEAD", 0));
   }
 
-  Dirent FileImpl::getDirent(size_type idx)
+  FileImpl::~FileImpl()
   {
-    log_trace("FileImpl::getDirent(" << idx << ')');
+    // the trace of the process is never destroyed
+    if (trace)
+      trace->flush();
+  }
 
-    zimFile.setBufsize(64);
+  void FileImpl::setTrace(const std::string& filename)
+  {
+    if (trace)
+      trace->flush();
 
-    if (idx >= getCountArticles())
-      throw ZimFileFormatError("article index out of range");
+    if (filename.empty())
+    {
+      trace = 0;
+      return;
+    }
+
+    AccessTrace& t = AccessTrace::getInstance();
+    if (!t.enabled())
+      t.open(filename);
+    else if (t.getFilename() != filename)
+      log_warn("accesses are traced into \"" << t.getFilename() << "\" instead of \"" << filename << '"');
 
-    if (!zimFile)
+    if (trace != &t)
     {
-      log_warn("file in error state");
-      throw ZimFileFormatError("file in error state");
+      trace = &t;
+      traceFile = trace->addFile(header.getUuid());
     }
+  }
 
-    std::pair<bool, Dirent> v = direntCache.getx(idx);
-    if (v.first)
+  template <typename T>
+  const T* FileImpl::preload(std::vector<T>& vec, offset_type pos, size_type count)
+  {
+    if (count == 0)
+      return 0;
+
+    offset_type size = static_cast<offset_type>(count) * sizeof(T);
+
+    // Use the mapped file directly, if the values need no conversion.
+    const char* p = zimFile.data(pos, size);
+    if (p && !isBigEndian() && reinterpret_cast<std::size_t>(p) % sizeof(T) == 0)
     {
-      log_debug("dirent " << idx << " found in cache; hits " << direntCache.getHits() << " misses " << direntCache.getMisses() << " ratio " << direntCache.hitRatio() * 100 << "% fillfactor " << direntCache.fillfactor());
-      return v.second;
+      log_debug("use " << count << " mapped pointers at offset " << pos);
+      return reinterpret_cast<const T*>(p);
     }
 
-    log_debug("dirent " << idx << " not found in cache; hits " << direntCache.getHits() << " misses " << direntCache.getMisses() << " ratio " << direntCache.hitRatio() * 100 << "% fillfactor " << direntCache.fillfactor());
+    log_debug("preload " << count << " pointers from offset " << pos);
+    vec.resize(count);
+    if (zimFile.readSome(reinterpret_cast<char*>(&vec[0]), pos, size) != size)
+      throw ZimFileFormatError("error reading pointer list");
+
+    if (isBigEndian())
+      for (typename std::vector<T>::iterator it = vec.begin(); it != vec.end(); ++it)
+        *it = fromLittleEndian(&*it);
+
+    return &vec[0];
+  }
+
+  void FileImpl::loadDirentArena()
+  {
+    size_type count = getCountArticles();
+
+    // the title index is copied first, since getIndexByTitle uses the arena
+    // as soon as it has entries
+    std::vector<size_type> titles;
+    titles.reserve(count);
+    for (size_type idx = 0; idx < count; ++idx)
+      titles.push_back(getIndexByTitle(idx));
+
+    direntArena.setTitleIndex(titles);
+    direntArena.reserve(count);
+
+    for (size_type idx = 0; idx < count; ++idx)
+      direntArena.add(readDirent(idx));
+
+    log_debug(count << " directory entries loaded; " << direntArena.getMemorySize() << " bytes used");
+
+    // the pointer lists are not needed any more
+    std::vector<offset_type>().swap(urlPtrs);
+    std::vector<size_type>().swap(titleIdx);
+    urlPtrList = 0;
+    titleIdxList = 0;
+  }
+
+  void FileImpl::loadUrlIndex()
+  {
+    std::string fname = filename + ".urlidx";
+    size_type count = getCountArticles();
+
+    if (urlIndex.read(fname, header.getUuid(), count))
+      return;
+
+    log_info("create url index for " << count << " articles");
+    urlIndex.init(count);
+    for (size_type idx = 0; idx < count; ++idx)
+    {
+      Dirent dirent = direntArena.empty() ? readDirent(idx) : direntArena.getDirent(idx);
+      urlIndex.insert(UrlIndex::hash(dirent.getNamespace(), dirent.getUrl()), idx);
+    }
 
-    offset_type indexOffset = getOffset(header.getUrlPtrPos(), idx);
+    try
+    {
+      urlIndex.write(fname, header.getUuid(), count);
+    }
+    catch (const std::exception& e)
+    {
+      log_warn(e.what());
+    }
+  }
 
-    zimFile.seekg(indexOffset);
-    if (!zimFile)
+  void FileImpl::createClusterOrder()
+  {
+    log_debug("create cluster order of " << getCountArticles() << " articles");
+
+    std::vector<BlobRequest> requests;
+    requests.reserve(getCountArticles());
+    for (size_type idx = 0; idx < getCountArticles(); ++idx)
     {
-      log_warn("failed to seek to directory entry");
-      throw ZimFileFormatError("failed to seek to directory entry");
+      Dirent dirent = direntArena.empty() ? readDirent(idx) : direntArena.getDirent(idx);
+
+      // articles without data are sorted to the end
+      BlobRequest r;
+      r.clusterIdx = dirent.isArticle() ? dirent.getClusterNumber() : std::numeric_limits<size_type>::max();
+      r.blobIdx = dirent.isArticle() ? dirent.getBlobNumber() : 0;
+      r.pos = idx;
+      requests.push_back(r);
     }
 
+    std::stable_sort(requests.begin(), requests.end());
+
+    std::vector<size_type> order;
+    order.reserve(requests.size());
+    for (std::vector<BlobRequest>::const_iterator it = requests.begin(); it != requests.end(); ++it)
+      order.push_back(it->pos);
+
+    clusterOrder.swap(order);
+  }
+
+  Dirent FileImpl::readDirent(size_type idx)
+  {
+    offset_type indexOffset = urlPtrList ? urlPtrList[idx]
+                                         : getOffset(header.getUrlPtrPos(), idx);
+
+    FileReaderStream in(zimFile, indexOffset, 256);
     Dirent dirent;
-    zimFile >> dirent;
+    in >> dirent;
 
-    if (!zimFile)
+    if (in.fail())
     {
       log_warn("failed to read to directory entry");
       throw ZimFileFormatError("failed to read directory entry");
     }
 
+    atomicAdd(direntBytesRead, static_cast<uint64_t>(dirent.getDirentSize()));
+
     log_debug("dirent read from " << indexOffset);
+    return dirent;
+  }
+
+  Dirent FileImpl::getDirent(size_type idx)
+  {
+    log_trace("FileImpl::getDirent(" << idx << ')');
+
+    OperationTimer timer(observer, operationGetDirent, idx);
+
+    if (idx >= getCountArticles())
+      throw ZimFileFormatError("article index out of range");
+
+    if (!direntArena.empty())
+      return direntArena.getDirent(idx);
+
+    std::pair<bool, Dirent> v = direntCache.getx(idx);
+    if (v.first)
+    {
+      log_debug("dirent " << idx << " found in cache; hits " << direntCache.getHits() << " misses " << direntCache.getMisses() << " ratio " << direntCache.hitRatio() * 100 << "% fillfactor " << direntCache.fillfactor());
+      if (tracing())
+        trace->record(traceFile, traceDirent, idx, true);
+      return v.second;
+    }
+
+    log_debug("dirent " << idx << " not found in cache; hits " << direntCache.getHits() << " misses " << direntCache.getMisses() << " ratio " << direntCache.hitRatio() * 100 << "% fillfactor " << direntCache.fillfactor());
+
+    uint64_t start = tracing() ? AccessTrace::now() : 0;
+    Dirent dirent = readDirent(idx);
     direntCache.put(idx, dirent);
 
+    if (tracing())
+      trace->record(traceFile, traceDirent, idx, false, dirent.getDirentSize(), 0,
+                    static_cast<size_type>(AccessTrace::now() - start));
+
     return dirent;
   }
 
@@ -145,11 +406,14 @@ namespace zim
     if (idx >= getCountArticles())
       throw ZimFileFormatError("article index out of range");
 
-    zimFile.seekg(header.getTitleIdxPos() + sizeof(size_type) * idx);
-    size_type ret;
-    zimFile.read(reinterpret_cast<char*>(&ret), sizeof(size_type));
+    if (!direntArena.empty())
+      return direntArena.getIndexByTitle(idx);
+
+    if (titleIdxList)
+      return titleIdxList[idx];
 
-    if (!zimFile)
+    size_type ret;
+    if (zimFile.readSome(reinterpret_cast<char*>(&ret), header.getTitleIdxPos() + sizeof(size_type) * idx, sizeof(size_type)) != sizeof(size_type))
       throw ZimFileFormatError("error reading title index");
 
     if (isBigEndian())
@@ -158,34 +422,398 @@ namespace zim
     return ret;
   }
 
+  size_type FileImpl::getIndexByClusterOrder(size_type idx)
+  {
+    if (idx >= getCountArticles())
+      throw ZimFileFormatError("article index out of range");
+
+    MutexLock lock(clusterOrderMutex);
+    if (clusterOrder.empty())
+      createClusterOrder();
+    return clusterOrder[idx];
+  }
+
   Cluster FileImpl::getCluster(size_type idx)
   {
     log_trace("getCluster(" << idx << ')');
 
+    OperationTimer timer(observer, operationGetCluster, idx);
+
     if (idx >= getCountClusters())
       throw ZimFileFormatError("cluster index out of range");
 
     Cluster cluster = clusterCache.get(idx);
+    if (tracing())
+      trace->record(traceFile, traceCluster, idx, cluster, 0, cluster.memorySize());
+    readahead.access(idx);
     if (cluster)
     {
       log_debug("cluster " << idx << " found in cache; hits " << clusterCache.getHits() << " misses " << clusterCache.getMisses() << " ratio " << clusterCache.hitRatio() * 100 << "% fillfactor " << clusterCache.fillfactor());
       return cluster;
     }
 
-    zimFile.setBufsize(16384);
+    cluster = readahead.wait(idx);
+    if (cluster)
+      return cluster;
+
+    return readCluster(idx, getClusterOffset(idx));
+  }
+
+  Blob FileImpl::getBlob(size_type clusterIdx, size_type blobIdx)
+  {
+    log_trace("getBlob(" << clusterIdx << ", " << blobIdx << ')');
+
+    OperationTimer timer(observer, operationGetBlob, clusterIdx);
+
+    if (clusterIdx >= getCountClusters())
+      throw ZimFileFormatError("cluster index out of range");
+
+    Cluster cluster = clusterCache.get(clusterIdx);
+    if (tracing())
+      trace->record(traceFile, traceCluster, clusterIdx, cluster, 0, cluster.memorySize());
+    readahead.access(clusterIdx);
+    if (cluster)
+      return cluster.getBlob(blobIdx);
+
+    offset_type clusterOffset = getClusterOffset(clusterIdx);
+
+    // clusters in the raw cluster cache are compressed and need no I/O
+    if (rawClusterCache.contains(clusterIdx))
+      return readCluster(clusterIdx, clusterOffset).getBlob(blobIdx);
+
+    char clusterHead[1 + sizeof(size_type)];
+    zimFile.read(clusterHead, clusterOffset, sizeof(clusterHead));
+
+    CompressionType compression = static_cast<CompressionType>(clusterHead[0]);
+    if (compression != zimcompNone && compression != zimcompDefault)
+    {
+      cluster = readahead.wait(clusterIdx);
+      if (!cluster)
+        cluster = readCluster(clusterIdx, clusterOffset);
+      return cluster.getBlob(blobIdx);
+    }
+
+    // The first offset tells the size of the offset list. Just the offsets
+    // of the requested blob and its data are read.
+
+    size_type first;
+    std::memcpy(&first, clusterHead + 1, sizeof(first));
+    first = fromLittleEndian(&first);
+    size_type n = first / sizeof(size_type);
+    if (n == 0 || blobIdx + 1 >= n)
+      throw ZimFileFormatError("blob index out of range");
+
+    size_type offsets[2];
+    zimFile.read(reinterpret_cast<char*>(offsets), clusterOffset + 1 + blobIdx * sizeof(size_type), sizeof(offsets));
+    offsets[0] = fromLittleEndian(&offsets[0]);
+    offsets[1] = fromLittleEndian(&offsets[1]);
+    if (offsets[0] < first || offsets[1] < offsets[0]
+      || clusterOffset + 1 + offsets[1] > getClusterEnd(clusterIdx))
+      throw ZimFileFormatError("error reading cluster data");
+
+    size_type size = offsets[1] - offsets[0];
+    offset_type blobOffset = clusterOffset + 1 + offsets[0];
+    log_debug("read blob " << blobIdx << " of uncompressed cluster " << clusterIdx << " with " << size << " bytes at offset " << blobOffset);
+
+    if (size == 0)
+      return Blob();
+
+    atomicAdd(clusterBytesRead[zimcompNone], static_cast<uint64_t>(size));
+
+    SmartPtr<ClusterImpl> impl = new ClusterImpl();
+    const char* p = zimFile.data(blobOffset, size);
+    if (p)
+      impl->setMappedBlob(p, size, zimFile.getMMapFile());
+    else
+      zimFile.read(impl->appendBlob(size), blobOffset, size);
+
+    return impl->getBlob(0);
+  }
+
+  std::vector<Blob> FileImpl::getArticleData(const std::vector<size_type>& idx)
+  {
+    log_trace("getArticleData(" << idx.size() << " articles)");
+
+    std::vector<Blob> ret(idx.size());
+
+    std::vector<BlobRequest> requests;
+    requests.reserve(idx.size());
+    for (std::vector<size_type>::size_type n = 0; n < idx.size(); ++n)
+    {
+      Dirent dirent = getDirent(idx[n]);
+      if (!dirent.isArticle())
+        continue;
+
+      BlobRequest r;
+      r.clusterIdx = dirent.getClusterNumber();
+      r.blobIdx = dirent.getBlobNumber();
+      r.pos = n;
+      requests.push_back(r);
+    }
+
+    std::sort(requests.begin(), requests.end());
+
+    // A single blob is fetched without reading the whole cluster, if it is
+    // uncompressed. All other clusters are fetched together, so that they
+    // can be decompressed in parallel.
+    bool parallel = decompressPool.getThreads() > 0;
+    std::vector<size_type> clusterIdx;
+    std::vector<std::vector<BlobRequest>::const_iterator> groups;
+
+    std::vector<BlobRequest>::const_iterator it = requests.begin();
+    while (it != requests.end())
+    {
+      std::vector<BlobRequest>::const_iterator e = it;
+      while (e != requests.end() && e->clusterIdx == it->clusterIdx)
+        ++e;
+
+      if (e - it == 1
+        && !(parallel && it->clusterIdx < getCountClusters()
+                      && !clusterCache.contains(it->clusterIdx)
+                      && (rawClusterCache.contains(it->clusterIdx)
+                       || isClusterCompressed(getClusterOffset(it->clusterIdx)))))
+      {
+        ret[it->pos] = getBlob(it->clusterIdx, it->blobIdx);
+      }
+      else
+      {
+        clusterIdx.push_back(it->clusterIdx);
+        groups.push_back(it);
+      }
+
+      it = e;
+    }
+
+    std::vector<Cluster> clusters = getClusters(clusterIdx);
+
+    for (std::vector<Cluster>::size_type n = 0; n < clusters.size(); ++n)
+    {
+      log_debug("fetch blobs from cluster " << clusterIdx[n]);
+      const Cluster& cluster = clusters[n];
+      for (it = groups[n]; it != requests.end() && it->clusterIdx == clusterIdx[n]; ++it)
+      {
+        if (it->blobIdx >= cluster.count())
+          throw ZimFileFormatError("blob index out of range");
+        ret[it->pos] = cluster.getBlob(it->blobIdx);
+      }
+    }
+
+    return ret;
+  }
+
+  std::vector<Cluster> FileImpl::getClusters(const std::vector<size_type>& idx)
+  {
+    log_trace("getClusters(" << idx.size() << " clusters)");
+
+    std::vector<Cluster> ret(idx.size());
+
+    // the clusters, which are not found in the cache, are loaded as jobs;
+    // jobPos maps the jobs to the positions in ret
+    std::vector<DecompressPool::Job> jobs;
+    std::vector<std::vector<Cluster>::size_type> jobPos;
+    std::map<size_type, std::vector<DecompressPool::Job>::size_type> jobIdx;
+
+    for (std::vector<size_type>::size_type n = 0; n < idx.size(); ++n)
+    {
+      if (idx[n] >= getCountClusters())
+        throw ZimFileFormatError("cluster index out of range");
 
+      if (jobIdx.find(idx[n]) != jobIdx.end())
+        continue;
+
+      ret[n] = clusterCache.get(idx[n]);
+      if (tracing())
+        trace->record(traceFile, traceCluster, idx[n], ret[n], 0, ret[n].memorySize());
+      if (!ret[n])
+      {
+        jobIdx[idx[n]] = jobs.size();
+        jobs.push_back(DecompressPool::Job(idx[n]));
+        jobPos.push_back(n);
+      }
+    }
+
+    decompressPool.load(jobs);
+
+    for (std::vector<DecompressPool::Job>::size_type n = 0; n < jobs.size(); ++n)
+    {
+      if (!jobs[n].error.empty())
+        throw ZimFileFormatError(jobs[n].error);
+      ret[jobPos[n]] = jobs[n].cluster;
+    }
+
+    // clusters requested more than once
+    for (std::vector<size_type>::size_type n = 0; n < idx.size(); ++n)
+      if (!ret[n])
+        ret[n] = ret[jobPos[jobIdx[idx[n]]]];
+
+    return ret;
+  }
+
+  Cluster FileImpl::prefetchCluster(size_type idx)
+  {
+    if (clusterCache.contains(idx))
+      return Cluster();
+
+    // uncompressed clusters are not cached, so there is nothing to prefetch
     offset_type clusterOffset = getClusterOffset(idx);
+    if (!rawClusterCache.contains(idx) && !isClusterCompressed(clusterOffset))
+      return Cluster();
+
+    return readCluster(idx, clusterOffset);
+  }
+
+  bool FileImpl::isClusterCompressed(offset_type clusterOffset)
+  {
+    char c;
+    zimFile.read(&c, clusterOffset, 1);
+    CompressionType compression = static_cast<CompressionType>(c);
+    return compression != zimcompNone && compression != zimcompDefault;
+  }
+
+  // the cluster ends, where the next cluster or the checksum starts
+  offset_type FileImpl::getClusterEnd(size_type idx)
+  {
+    return idx + 1 < getCountClusters() ? getClusterOffset(idx + 1)
+         : header.hasChecksum()         ? header.getChecksumPos()
+         :                                getFilesize();
+  }
+
+  Cluster FileImpl::readCluster(size_type idx, offset_type clusterOffset)
+  {
+    // The cluster is read without holding a lock, so that other threads
+    // are not blocked while decompressing. When 2 threads miss the same
+    // cluster at the same time, it is just read twice.
+
     log_debug("read cluster " << idx << " from offset " << clusterOffset);
-    zimFile.seekg(clusterOffset);
-    zimFile >> cluster;
 
-    if (zimFile.fail())
-      throw ZimFileFormatError("error reading cluster data");
+    uint64_t start = tracing() ? AccessTrace::now() : 0;
+    offset_type bytesRead = 0;
+
+    offset_type clusterEnd = getClusterEnd(idx);
+    offset_type clusterSize = clusterEnd > clusterOffset ? clusterEnd - clusterOffset : 0;
+
+    // clusters decompressed before, possibly by another process; just
+    // compressed clusters are written to the cluster directory
+    Cluster cluster;
+    if (clusterDiskCache.enabled() && isClusterCompressed(clusterOffset))
+      cluster = clusterDiskCache.get(idx, clusterOffset, clusterSize);
+    size_type uncompressedSize = 0;
+    size_type blobCount = 0;
+
+    bool fromDisk = cluster;
+    bool keepRaw = !fromDisk && rawClusterCache.getMaxCost() > 0;
+
+    // a cluster found in the raw cluster cache just needs to be decompressed
+    Blob raw;
+    if (keepRaw)
+      raw = rawClusterCache.get(idx);
+
+    if (fromDisk)
+      log_debug("cluster " << idx << " found in cluster directory");
+    else if (raw.data())
+    {
+      log_debug("cluster " << idx << " found in raw cluster cache");
+
+      // the cluster info is just used, when it needs no I/O
+      if (clusterInfoList)
+        getClusterInfo(idx, uncompressedSize, blobCount);
+
+      if (!decodeCluster(cluster, raw.data(), raw.size(), uncompressedSize))
+        throw ZimFileFormatError("error reading cluster data");
+
+      keepRaw = false;
+    }
+    else
+    {
+      if (clusterSize > 0 && clusterEnd <= getFilesize())
+      {
+        // The exact byte range of the cluster is known, so the compressed
+        // data is taken from the mapped file or read with a single pread and
+        // decoded directly from the buffer.
+        bool hasInfo = getClusterInfo(idx, uncompressedSize, blobCount);
+        bytesRead = clusterSize;
+
+        const char* p = zimFile.getMMapFile() ? zimFile.data(clusterOffset, clusterSize) : 0;
+        bool mapped = p != 0;
+        std::vector<char> buffer;
+        if (!mapped && keepRaw)
+        {
+          // read into a pool buffer, which is kept in the raw cluster cache
+          SmartPtr<ClusterImpl> impl = new ClusterImpl();
+          zimFile.read(impl->appendBlob(clusterSize), clusterOffset, clusterSize);
+          raw = impl->getBlob(0);
+          p = raw.data();
+        }
+        else if (!mapped)
+        {
+          buffer.resize(clusterSize);
+          zimFile.read(&buffer[0], clusterOffset, clusterSize);
+          p = &buffer[0];
+        }
+
+        bool ok;
+        CompressionType compression = static_cast<CompressionType>(*p);
+        if (static_cast<unsigned>(compression) < FileStats::compressionTypes)
+          atomicAdd(clusterBytesRead[compression], static_cast<uint64_t>(clusterSize));
+
+        if (mapped && (compression == zimcompNone || compression == zimcompDefault))
+        {
+          // uncompressed clusters are not copied; the blobs point directly
+          // into the mapped file
+          cluster.setCompression(compression);
+          ok = cluster.readMapped(p + 1, clusterSize - 1, zimFile.getMMapFile());
+        }
+        else
+          ok = decodeCluster(cluster, p, clusterSize, uncompressedSize);
+
+        if (!ok)
+          throw ZimFileFormatError("error reading cluster data");
+
+        if (hasInfo && cluster.count() != blobCount)
+          throw ZimFileFormatError("cluster does not match cluster info");
+
+        if (keepRaw && cluster.isCompressed() && !raw.data())
+        {
+          SmartPtr<ClusterImpl> impl = new ClusterImpl();
+          std::memcpy(impl->appendBlob(clusterSize), p, clusterSize);
+          raw = impl->getBlob(0);
+        }
+      }
+      else
+      {
+        uint64_t start = AccessTrace::now();
+        FileReaderStream in(zimFile, clusterOffset, 16384);
+        in >> cluster;
+
+        if (in.fail())
+          throw ZimFileFormatError("error reading cluster data");
+
+        if (cluster.isCompressed())
+        {
+          atomicIncrement(clustersDecompressed);
+          atomicAdd(decompressMicroseconds, AccessTrace::now() - start);
+        }
+      }
+    }
+
+    if (tracing())
+      trace->record(traceFile, traceClusterRead, idx, false, static_cast<size_type>(bytesRead),
+                    cluster.memorySize(), static_cast<size_type>(AccessTrace::now() - start),
+                    cluster.getCompression());
+
+    if (keepRaw && cluster.isCompressed() && raw.data())
+    {
+      log_debug("put " << raw.size() << " bytes of cluster " << idx << " into raw cluster cache; hits " << rawClusterCache.getHits() << " misses " << rawClusterCache.getMisses() << " bytes " << rawClusterCache.getCost());
+      rawClusterCache.put(idx, raw, raw.size());
+    }
+
+    if (!fromDisk && cluster.isCompressed())
+      clusterDiskCache.put(idx, clusterOffset, clusterSize, cluster);
 
     if (cluster.isCompressed())
     {
-      log_debug("put cluster " << idx << " into cluster cache; hits " << clusterCache.getHits() << " misses " << clusterCache.getMisses() << " ratio " << clusterCache.hitRatio() * 100 << "% fillfactor " << clusterCache.fillfactor());
-      clusterCache.put(idx, cluster);
+      log_debug("put cluster " << idx << " with " << cluster.memorySize() << " bytes into cluster cache; hits " << clusterCache.getHits() << " misses " << clusterCache.getMisses() << " ratio " << clusterCache.hitRatio() * 100 << "% fillfactor " << clusterCache.fillfactor() << " bytes " << clusterCache.getCost() << " peak " << clusterCache.getPeakCost());
+      clusterCache.put(idx, cluster, cluster.memorySize());
     }
     else
       log_debug("cluster " << idx << " is not compressed - do not cache");
@@ -193,13 +821,86 @@ namespace zim
     return cluster;
   }
 
+  bool FileImpl::decodeCluster(Cluster& cluster, const char* data, offset_type size, size_type sizeHint)
+  {
+    uint64_t start = AccessTrace::now();
+    bool ok = cluster.readBuffer(data, size, sizeHint);
+    if (ok && cluster.isCompressed())
+    {
+      atomicIncrement(clustersDecompressed);
+      atomicAdd(decompressMicroseconds, AccessTrace::now() - start);
+    }
+    return ok;
+  }
+
+  FileStats FileImpl::getStats() const
+  {
+    FileStats stats;
+
+    stats.direntCacheHits = direntCache.getHits();
+    stats.direntCacheMisses = direntCache.getMisses();
+    stats.direntCacheEvictions = direntCache.getEvictions();
+
+    stats.clusterCacheHits = clusterCache.getHits();
+    stats.clusterCacheMisses = clusterCache.getMisses();
+    stats.clusterCacheEvictions = clusterCache.getEvictions();
+
+    stats.direntBytesRead = atomicGet(direntBytesRead);
+    for (unsigned c = 0; c < FileStats::compressionTypes; ++c)
+      stats.clusterBytesRead[c] = atomicGet(clusterBytesRead[c]);
+
+    stats.clustersDecompressed = atomicGet(clustersDecompressed);
+    stats.decompressMicroseconds = atomicGet(decompressMicroseconds);
+
+    stats.urlLookups = atomicGet(urlLookups);
+    stats.titleLookups = atomicGet(titleLookups);
+    stats.lookupSteps = atomicGet(lookupSteps);
+
+    stats.bufferPoolBytes = BufferPool::getInstance().getPooledBytes();
+
+    return stats;
+  }
+
+  bool FileImpl::getClusterInfo(size_type idx, size_type& size, size_type& count)
+  {
+    if (!header.hasClusterInfo())
+      return false;
+
+    if (idx >= getCountClusters())
+      throw ZimFileFormatError("cluster index out of range");
+
+    if (clusterInfoList)
+    {
+      size = clusterInfoList[idx * 2];
+      count = clusterInfoList[idx * 2 + 1];
+      return true;
+    }
+
+    size_type info[2];
+    if (zimFile.readSome(reinterpret_cast<char*>(info), header.getClusterInfoPos() + sizeof(info) * idx, sizeof(info)) != sizeof(info))
+      throw ZimFileFormatError("error reading cluster info");
+
+    size = fromLittleEndian(&info[0]);
+    count = fromLittleEndian(&info[1]);
+    return true;
+  }
+
+  offset_type FileImpl::getClusterOffset(size_type idx)
+  {
+    if (clusterPtrList)
+    {
+      if (idx >= getCountClusters())
+        throw ZimFileFormatError("cluster index out of range");
+      return clusterPtrList[idx];
+    }
+
+    return getOffset(header.getClusterPtrPos(), idx);
+  }
+
   offset_type FileImpl::getOffset(offset_type ptrOffset, size_type idx)
   {
-    zimFile.seekg(ptrOffset + sizeof(offset_type) * idx);
     offset_type offset;
-    zimFile.read(reinterpret_cast<char*>(&offset), sizeof(offset_type));
-
-    if (!zimFile)
+    if (zimFile.readSome(reinterpret_cast<char*>(&offset), ptrOffset + sizeof(offset_type) * idx, sizeof(offset_type)) != sizeof(offset_type))
       throw ZimFileFormatError("error reading offset");
 
     if (isBigEndian())
@@ -212,9 +913,15 @@ namespace zim
   {
     log_trace("getNamespaceBeginOffset(" << ch << ')');
 
-    NamespaceCache::const_iterator it = namespaceBeginCache.find(ch);
-    if (it != namespaceBeginCache.end())
-      return it->second;
+    if (!direntArena.empty())
+      return direntArena.getNamespaceBeginOffset(ch);
+
+    {
+      MutexLock lock(namespaceMutex);
+      NamespaceCache::const_iterator it = namespaceBeginCache.find(ch);
+      if (it != namespaceBeginCache.end())
+        return it->second;
+    }
 
     size_type lower = 0;
     size_type upper = getCountArticles();
@@ -230,6 +937,8 @@ namespace zim
     }
 
     size_type ret = d.getNamespace() < ch ? upper : lower;
+
+    MutexLock lock(namespaceMutex);
     namespaceBeginCache[ch] = ret;
 
     return ret;
@@ -239,9 +948,15 @@ namespace zim
   {
     log_trace("getNamespaceEndOffset(" << ch << ')');
 
-    NamespaceCache::const_iterator it = namespaceEndCache.find(ch);
-    if (it != namespaceEndCache.end())
-      return it->second;
+    if (!direntArena.empty())
+      return direntArena.getNamespaceEndOffset(ch);
+
+    {
+      MutexLock lock(namespaceMutex);
+      NamespaceCache::const_iterator it = namespaceEndCache.find(ch);
+      if (it != namespaceEndCache.end())
+        return it->second;
+    }
 
     size_type lower = 0;
     size_type upper = getCountArticles();
@@ -257,6 +972,7 @@ namespace zim
       log_debug("namespace " << d.getNamespace() << " m=" << m << " lower=" << lower << " upper=" << upper);
     }
 
+    MutexLock lock(namespaceMutex);
     namespaceEndCache[ch] = upper;
 
     return upper;
@@ -265,19 +981,24 @@ namespace zim
 
   std::string FileImpl::getNamespaces()
   {
-    if (namespaces.empty())
     {
-      Dirent d = getDirent(0);
-      namespaces = d.getNamespace();
+      MutexLock lock(namespaceMutex);
+      if (!namespaces.empty())
+        return namespaces;
+    }
 
-      size_type idx;
-      while ((idx = getNamespaceEndOffset(d.getNamespace())) < getCountArticles())
-      {
-        d = getDirent(idx);
-        namespaces += d.getNamespace();
-      }
+    Dirent d = getDirent(0);
+    std::string ret(1, d.getNamespace());
 
+    size_type idx;
+    while ((idx = getNamespaceEndOffset(d.getNamespace())) < getCountArticles())
+    {
+      d = getDirent(idx);
+      ret += d.getNamespace();
     }
+
+    MutexLock lock(namespaceMutex);
+    namespaces = ret;
     return namespaces;
   }
 
@@ -298,10 +1019,8 @@ namespace zim
     if (!header.hasChecksum())
       return std::string();
 
-    zimFile.seekg(header.getChecksumPos());
     unsigned char chksum[16];
-    zimFile.read(reinterpret_cast<char*>(chksum), 16);
-    if (!zimFile)
+    if (zimFile.readSome(reinterpret_cast<char*>(chksum), header.getChecksumPos(), 16) != 16)
     {
       log_warn("error reading checksum");
       return std::string();
@@ -327,17 +1046,25 @@ namespace zim
 
     Md5stream md5;
 
-    zimFile.seekg(0);
-    char ch;
-    for (offset_type n = 0; n < header.getChecksumPos() && zimFile.get(ch); ++n)
-      md5 << ch;
-
     unsigned char chksumFile[16];
     unsigned char chksumCalc[16];
 
-    zimFile.read(reinterpret_cast<char*>(chksumFile), 16);
+    offset_type checksumPos = header.getChecksumPos();
+    const char* p = zimFile.data(0, checksumPos);
+    if (p)
+      md5.write(p, checksumPos);
+    else
+    {
+      FileReaderStream in(zimFile, 0, 16384);
+      char ch;
+      for (offset_type n = 0; n < checksumPos && in.get(ch); ++n)
+        md5 << ch;
+
+      if (in.fail())
+        throw ZimFileFormatError("failed to read zim file");
+    }
 
-    if (!zimFile)
+    if (zimFile.readSome(reinterpret_cast<char*>(chksumFile), checksumPos, 16) != 16)
       throw ZimFileFormatError("failed to read checksum from zim file");
 
     md5.getDigest(chksumCalc);
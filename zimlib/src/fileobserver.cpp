@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include <zim/fileobserver.h>
+#include <time.h>
+#include <sys/time.h>
+
+namespace zim
+{
+  const char* getOperationName(FileOperation op)
+  {
+    switch (op)
+    {
+      case operationFindUrl:     return "findUrl";
+      case operationFindTitle:   return "findTitle";
+      case operationGetDirent:   return "getDirent";
+      case operationGetCluster:  return "getCluster";
+      case operationGetBlob:     return "getBlob";
+    }
+    return "unknown";
+  }
+
+  uint64_t FileObserver::now()
+  {
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+      return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return static_cast<uint64_t>(tv.tv_sec) * 1000000000 + tv.tv_usec * 1000;
+  }
+
+}
@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/filereader.h>
+#include "log.h"
+#include "config.h"
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifndef O_LARGEFILE
+#define O_LARGEFILE 0
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+log_define("zim.filereader")
+
+namespace zim
+{
+  namespace
+  {
+    class FileNotFound : public std::runtime_error
+    {
+      public:
+        FileNotFound()
+          : std::runtime_error("file not found")
+          { }
+    };
+  }
+
+  ////////////////////////////////////////////////////////////
+  // FileReader
+  //
+  FileReader::FileReader(const std::string& fname)
+    : mtime(0)
+  {
+    try
+    {
+      addPart(fname);
+    }
+    catch (const FileNotFound&)
+    {
+      int errnoSave = errno;
+      try
+      {
+        for (char ch0 = 'a'; ch0 <= 'z'; ++ch0)
+        {
+          std::string fname0 = fname + ch0;
+          for (char ch1 = 'a'; ch1 <= 'z'; ++ch1)
+            addPart(fname0 + ch1);
+        }
+      }
+      catch (const FileNotFound&)
+      {
+        if (parts.empty())
+        {
+          std::ostringstream msg;
+          msg << "error " << errnoSave << " opening file \"" << fname << "\": " << strerror(errnoSave);
+          throw std::runtime_error(msg.str());
+        }
+      }
+      catch (...)
+      {
+        closeParts();
+        throw;
+      }
+    }
+
+#ifdef HAVE_STAT64
+    struct stat64 st;
+    int ret = ::fstat64(parts.front().fd, &st);
+#else
+    struct stat st;
+    int ret = ::fstat(parts.front().fd, &st);
+#endif
+    if (ret != 0)
+    {
+      int errnoSave = errno;
+      closeParts();
+      std::ostringstream msg;
+      msg << "stat failed with errno " << errnoSave << " : " << strerror(errnoSave);
+      throw std::runtime_error(msg.str());
+    }
+
+    mtime = st.st_mtime;
+  }
+
+  FileReader::~FileReader()
+  {
+    closeParts();
+  }
+
+  void FileReader::addPart(const std::string& fname)
+  {
+    Part part;
+    part.fname = fname;
+#ifdef HAVE_OPEN64
+    part.fd = ::open64(fname.c_str(), O_RDONLY | O_LARGEFILE | O_BINARY);
+#else
+    part.fd = ::open(fname.c_str(), O_RDONLY | O_LARGEFILE | O_BINARY);
+#endif
+    if (part.fd < 0)
+      throw FileNotFound();
+
+#if defined(_WIN32)
+    __int64 ret = ::_lseeki64(part.fd, 0, SEEK_END);
+#elif defined(HAVE_LSEEK64)
+    off64_t ret = ::lseek64(part.fd, 0, SEEK_END);
+#else
+    off_t ret = ::lseek(part.fd, 0, SEEK_END);
+#endif
+    if (ret < 0)
+    {
+      int errnoSave = errno;
+      ::close(part.fd);
+      std::ostringstream msg;
+      msg << "error " << errnoSave << " seeking to end in file " << fname << ": " << strerror(errnoSave);
+      throw std::runtime_error(msg.str());
+    }
+
+    part.offset = fsize();
+    part.size = static_cast<offset_type>(ret);
+
+    log_debug("file part \"" << fname << "\" with " << part.size << " bytes at offset " << part.offset);
+
+    parts.push_back(part);
+  }
+
+  void FileReader::closeParts()
+  {
+    for (Parts::iterator it = parts.begin(); it != parts.end(); ++it)
+      ::close(it->fd);
+    parts.clear();
+  }
+
+  bool FileReader::map()
+  {
+    if (mmapFile)
+      return true;
+
+    try
+    {
+      mmapFile = new MMapFile(getFilenames());
+      return true;
+    }
+    catch (const std::exception& e)
+    {
+      log_warn("failed to map file \"" << parts.front().fname << "\": " << e.what());
+      return false;
+    }
+  }
+
+  void FileReader::read(char* dest, offset_type off, offset_type size) const
+  {
+    if (readSome(dest, off, size) != size)
+    {
+      std::ostringstream msg;
+      msg << "error reading " << size << " bytes at offset " << off << ": unexpected end of file";
+      throw std::runtime_error(msg.str());
+    }
+  }
+
+  offset_type FileReader::readSome(char* dest, offset_type off, offset_type size) const
+  {
+    const char* p = data(off, size);
+    if (p)
+    {
+      std::memcpy(dest, p, size);
+      return size;
+    }
+
+    offset_type count = 0;
+    Parts::const_iterator it = parts.begin();
+    while (count < size)
+    {
+      while (it != parts.end() && off >= it->offset + it->size)
+        ++it;
+
+      if (it == parts.end())
+        break;
+
+      offset_type n = std::min(size - count, it->offset + it->size - off);
+
+#if defined(HAVE_PREAD64)
+      ssize_t r = ::pread64(it->fd, dest + count, n, off - it->offset);
+#elif defined(HAVE_PREAD)
+      ssize_t r = ::pread(it->fd, dest + count, n, off - it->offset);
+#else
+      int r;
+      {
+        MutexLock lock(readMutex);
+#if defined(_WIN32)
+        __int64 s = ::_lseeki64(it->fd, off - it->offset, SEEK_SET);
+#elif defined(HAVE_LSEEK64)
+        off64_t s = ::lseek64(it->fd, off - it->offset, SEEK_SET);
+#else
+        off_t s = ::lseek(it->fd, off - it->offset, SEEK_SET);
+#endif
+        r = s < 0 ? -1 : ::read(it->fd, dest + count, n);
+      }
+#endif
+
+      if (r < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        std::ostringstream msg;
+        msg << "error " << errno << " reading from file " << it->fname << ": " << strerror(errno);
+        throw std::runtime_error(msg.str());
+      }
+
+      if (r == 0)
+        break;
+
+      count += r;
+      off += r;
+    }
+
+    return count;
+  }
+
+  std::vector<std::string> FileReader::getFilenames() const
+  {
+    std::vector<std::string> ret;
+    for (Parts::const_iterator it = parts.begin(); it != parts.end(); ++it)
+      ret.push_back(it->fname);
+    return ret;
+  }
+
+  ////////////////////////////////////////////////////////////
+  // FileReaderStreamBuf
+  //
+  FileReaderStreamBuf::int_type FileReaderStreamBuf::underflow()
+  {
+    // pass mapped data without copying
+    offset_type n = reader.contiguousSize(pos);
+    if (n > 0)
+    {
+      if (n > static_cast<offset_type>(std::numeric_limits<int>::max()))
+        n = std::numeric_limits<int>::max();
+      char* p = const_cast<char*>(reader.data(pos, n));
+      setg(p, p, p + n);
+      pos += n;
+      return traits_type::to_int_type(*gptr());
+    }
+
+    if (buffer.empty())
+      buffer.resize(bufsize);
+
+    n = reader.readSome(&buffer[0], pos, buffer.size());
+    if (n == 0)
+      return traits_type::eof();
+
+    pos += n;
+    char* p = &buffer[0];
+    setg(p, p, p + n);
+    return traits_type::to_int_type(*gptr());
+  }
+
+}
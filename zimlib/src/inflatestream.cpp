@@ -21,6 +21,8 @@
 #include "zim/inflatestream.h"
 #include "log.h"
 #include <sstream>
+#include <vector>
+#include "decoderpool.h"
 
 log_define("zim.inflatestream")
 
@@ -43,26 +45,80 @@ namespace zim
     }
   }
 
+  struct InflateStreamBuf::Decoder
+  {
+    z_stream stream;
+    std::vector<char> buffer;
+    bool initialized;
+
+    Decoder()
+      : initialized(false)
+      { }
+    ~Decoder()
+      { if (initialized) ::inflateEnd(&stream); }
+  };
+
+  namespace
+  {
+    DecoderPool<InflateStreamBuf::Decoder>& decoderPool()
+      { return DecoderPool<InflateStreamBuf::Decoder>::getInstance(); }
+
+    InflateStreamBuf::Decoder* getDecoder(unsigned bufsize)
+    {
+      InflateStreamBuf::Decoder* decoder = decoderPool().get();
+      if (decoder == 0)
+        decoder = new InflateStreamBuf::Decoder();
+      if (decoder->buffer.size() < bufsize)
+        decoder->buffer.resize(bufsize);
+      return decoder;
+    }
+
+    void initDecoder(InflateStreamBuf::Decoder* decoder)
+    {
+      z_stream& stream = decoder->stream;
+      stream.next_in = Z_NULL;
+      stream.avail_in = 0;
+
+      if (decoder->initialized)
+      {
+        // keeps the allocated state and window
+        checkError(::inflateReset(&stream), stream);
+      }
+      else
+      {
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = 0;
+        stream.total_out = 0;
+        stream.total_in = 0;
+
+        checkError(::inflateInit(&stream), stream);
+        decoder->initialized = true;
+      }
+    }
+  }
+
   InflateStreamBuf::InflateStreamBuf(std::streambuf* sinksource_, unsigned bufsize_)
-    : iobuffer(new char_type[bufsize_]),
+    : decoder(getDecoder(bufsize_)),
+      stream(decoder->stream),
+      iobuffer(&decoder->buffer[0]),
       bufsize(bufsize_),
       sinksource(sinksource_)
   {
-    stream.zalloc = Z_NULL;
-    stream.zfree = Z_NULL;
-    stream.opaque = 0;
-    stream.total_out = 0;
-    stream.total_in = 0;
-    stream.next_in = Z_NULL;
-    stream.avail_in = 0;
-
-    checkError(::inflateInit(&stream), stream);
+    try
+    {
+      initDecoder(decoder);
+    }
+    catch (...)
+    {
+      delete decoder;
+      throw;
+    }
   }
 
   InflateStreamBuf::~InflateStreamBuf()
   {
-    ::inflateEnd(&stream);
-    delete[] iobuffer;
+    decoderPool().put(decoder);
   }
 
   InflateStreamBuf::int_type InflateStreamBuf::overflow(int_type c)
@@ -143,6 +199,60 @@ namespace zim
     return sgetc();
   }
 
+  void inflateBuffer(const char* data, std::size_t size, Buffer& out, std::size_t sizeHint)
+  {
+    InflateStreamBuf::Decoder* decoder = getDecoder(0);
+    z_stream& stream = decoder->stream;
+
+    try
+    {
+      initDecoder(decoder);
+
+      stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+      stream.avail_in = size;
+
+      out.resize(initialOutputSize(size, sizeHint));
+      std::size_t count = 0;
+      while (true)
+      {
+        if (count == out.size())
+          out.resize(out.size() * 2);
+
+        stream.next_out = reinterpret_cast<Bytef*>(&out[count]);
+        stream.avail_out = out.size() - count;
+
+        int ret = ::inflate(&stream, Z_NO_FLUSH);
+
+        count = out.size() - stream.avail_out;
+
+        // Older versions of the writer just flushed the stream instead of
+        // finishing it, so the input may end without Z_STREAM_END. When its
+        // output filled the buffer exactly, the next call finds no input
+        // and reports Z_BUF_ERROR. A truncated cluster is detected by its
+        // offsets.
+        if (ret == Z_BUF_ERROR && stream.avail_in == 0)
+          break;
+
+        checkError(ret, stream);
+
+        if (ret == Z_STREAM_END)
+          break;
+
+        if (stream.avail_in == 0 && stream.avail_out > 0)
+          break;
+      }
+
+      out.resize(count);
+    }
+    catch (...)
+    {
+      decoderPool().put(decoder);
+      throw;
+    }
+
+    decoderPool().put(decoder);
+  }
+
   int InflateStreamBuf::sync()
   {
     if (pptr() && overflow(traits_type::eof()) == traits_type::eof())
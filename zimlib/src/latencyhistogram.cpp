@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include <zim/latencyhistogram.h>
+#include <zim/atomic.h>
+
+namespace zim
+{
+  unsigned LatencyHistogram::bucketIndex(uint64_t value)
+  {
+    if (value < 2 * subBucketCount)
+      return static_cast<unsigned>(value);
+
+    if (value >> maxValueBits)
+      return bucketCount - 1;
+
+    // the position of the highest bit gives the power of 2 and the
+    // following subBucketBits bits the sub bucket
+    unsigned msb = 0;
+    for (uint64_t v = value; v > 1; v >>= 1)
+      ++msb;
+
+    unsigned shift = msb - subBucketBits;
+    unsigned sub = static_cast<unsigned>(value >> shift) - subBucketCount;
+    return 2 * subBucketCount + (shift - 1) * subBucketCount + sub;
+  }
+
+  uint64_t LatencyHistogram::bucketLow(unsigned bucket)
+  {
+    if (bucket < 2 * subBucketCount)
+      return bucket;
+
+    unsigned shift = (bucket - 2 * subBucketCount) / subBucketCount + 1;
+    uint64_t sub = (bucket - 2 * subBucketCount) % subBucketCount + subBucketCount;
+    return sub << shift;
+  }
+
+  uint64_t LatencyHistogram::bucketHigh(unsigned bucket)
+  {
+    if (bucket < 2 * subBucketCount)
+      return bucket;
+
+    if (bucket == bucketCount - 1)
+      return ~static_cast<uint64_t>(0);
+
+    return bucketLow(bucket + 1) - 1;
+  }
+
+  void LatencyHistogram::record(uint64_t value)
+  {
+    atomicIncrement(counts[bucketIndex(value)]);
+    atomicAdd(sum, value);
+
+    uint64_t m;
+    while (value < (m = min) && !atomicCompareExchange(min, m, value))
+      ;
+    while (value > (m = max) && !atomicCompareExchange(max, m, value))
+      ;
+
+    // the count is incremented last, so that min is valid, when count > 0
+    atomicIncrement(count);
+  }
+
+  void LatencyHistogram::add(const LatencyHistogram& h)
+  {
+    if (h.count == 0)
+      return;
+
+    for (unsigned b = 0; b < bucketCount; ++b)
+      if (h.counts[b])
+        atomicAdd(counts[b], static_cast<uint64_t>(h.counts[b]));
+    atomicAdd(sum, static_cast<uint64_t>(h.sum));
+
+    uint64_t m;
+    uint64_t v = h.min;
+    while (v < (m = min) && !atomicCompareExchange(min, m, v))
+      ;
+    v = h.max;
+    while (v > (m = max) && !atomicCompareExchange(max, m, v))
+      ;
+
+    atomicAdd(count, static_cast<uint64_t>(h.count));
+  }
+
+  void LatencyHistogram::clear()
+  {
+    for (unsigned b = 0; b < bucketCount; ++b)
+      counts[b] = 0;
+    count = 0;
+    sum = 0;
+    min = ~static_cast<uint64_t>(0);
+    max = 0;
+  }
+
+  uint64_t LatencyHistogram::getPercentile(double percentile) const
+  {
+    uint64_t total = 0;
+    for (unsigned b = 0; b < bucketCount; ++b)
+      total += counts[b];
+
+    if (total == 0)
+      return 0;
+
+    // the rank of the requested value, counted from 1
+    double r = percentile / 100 * static_cast<double>(total);
+    uint64_t rank = static_cast<uint64_t>(r);
+    if (static_cast<double>(rank) < r)
+      ++rank;
+    if (rank < 1)
+      rank = 1;
+    if (rank > total)
+      rank = total;
+
+    uint64_t n = 0;
+    for (unsigned b = 0; b < bucketCount; ++b)
+    {
+      n += counts[b];
+      if (n >= rank)
+      {
+        uint64_t high = bucketHigh(b);
+        uint64_t m = max;
+        return high < m ? high : m;
+      }
+    }
+
+    return max;
+  }
+
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/mmapfile.h>
+#include "log.h"
+#include "config.h"
+#include <sstream>
+#include <stdexcept>
+#include <limits>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifndef O_LARGEFILE
+#define O_LARGEFILE 0
+#endif
+
+log_define("zim.mmapfile")
+
+namespace zim
+{
+#ifdef HAVE_MMAP
+
+  MMapFile::MMapFile(const std::vector<std::string>& fnames)
+  {
+    offset_type offset = 0;
+
+    try
+    {
+      for (std::vector<std::string>::const_iterator it = fnames.begin(); it != fnames.end(); ++it)
+      {
+#ifdef HAVE_OPEN64
+        int fd = ::open64(it->c_str(), O_RDONLY | O_LARGEFILE);
+#else
+        int fd = ::open(it->c_str(), O_RDONLY | O_LARGEFILE);
+#endif
+        if (fd < 0)
+        {
+          std::ostringstream msg;
+          msg << "error " << errno << " opening file \"" << *it << "\": " << strerror(errno);
+          throw std::runtime_error(msg.str());
+        }
+
+#ifdef HAVE_STAT64
+        struct stat64 st;
+        int ret = ::fstat64(fd, &st);
+#else
+        struct stat st;
+        int ret = ::fstat(fd, &st);
+#endif
+        if (ret != 0)
+        {
+          int errnoSave = errno;
+          ::close(fd);
+          std::ostringstream msg;
+          msg << "stat failed with errno " << errnoSave << " : " << strerror(errnoSave);
+          throw std::runtime_error(msg.str());
+        }
+
+        Part part;
+        part.offset = offset;
+        part.size = static_cast<offset_type>(st.st_size);
+        part.data = 0;
+
+        if (part.size > static_cast<offset_type>(std::numeric_limits<size_t>::max()))
+        {
+          ::close(fd);
+          throw std::runtime_error("file \"" + *it + "\" too large to be mapped");
+        }
+
+        if (part.size > 0)
+        {
+          void* addr = ::mmap(0, static_cast<size_t>(part.size), PROT_READ, MAP_SHARED, fd, 0);
+          if (addr == MAP_FAILED)
+          {
+            int errnoSave = errno;
+            ::close(fd);
+            std::ostringstream msg;
+            msg << "error " << errnoSave << " mapping file \"" << *it << "\": " << strerror(errnoSave);
+            throw std::runtime_error(msg.str());
+          }
+          part.data = static_cast<char*>(addr);
+        }
+
+        // the mapping stays valid after closing the file descriptor
+        ::close(fd);
+
+        log_debug("file \"" << *it << "\" with " << part.size << " bytes mapped at offset " << offset);
+
+        parts.push_back(part);
+        offset += part.size;
+      }
+    }
+    catch (...)
+    {
+      for (Parts::iterator it = parts.begin(); it != parts.end(); ++it)
+        if (it->data)
+          ::munmap(it->data, static_cast<size_t>(it->size));
+      throw;
+    }
+  }
+
+  MMapFile::~MMapFile()
+  {
+    for (Parts::iterator it = parts.begin(); it != parts.end(); ++it)
+      if (it->data)
+        ::munmap(it->data, static_cast<size_t>(it->size));
+  }
+
+#else
+
+  MMapFile::MMapFile(const std::vector<std::string>& fnames)
+  {
+    throw std::runtime_error("mmap not supported on this platform");
+  }
+
+  MMapFile::~MMapFile()
+  { }
+
+#endif
+
+  const MMapFile::Part* MMapFile::findPart(offset_type off) const
+  {
+    for (Parts::const_iterator it = parts.begin(); it != parts.end(); ++it)
+      if (off < it->offset + it->size)
+        return &*it;
+    return 0;
+  }
+
+  const char* MMapFile::data(offset_type off, offset_type size) const
+  {
+    const Part* part = findPart(off);
+    if (part == 0 || off + size > part->offset + part->size)
+      return 0;
+    return part->data + (off - part->offset);
+  }
+
+  offset_type MMapFile::contiguousSize(offset_type off) const
+  {
+    const Part* part = findPart(off);
+    return part ? part->offset + part->size - off : 0;
+  }
+
+  offset_type MMapFile::fsize() const
+  {
+    return parts.empty() ? 0 : parts.back().offset + parts.back().size;
+  }
+
+}
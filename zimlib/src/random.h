@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_RANDOM_H
+#define ZIM_RANDOM_H
+
+#include <zim/zim.h>
+
+namespace zim
+{
+  /**
+     Deterministic random numbers for the tools and benchmarks (splitmix64).
+     The same seed gives the same sequence on every machine, so that
+     generated files and access patterns are reproducible.
+   */
+  class Random
+  {
+      uint64_t state;
+
+    public:
+      explicit Random(uint64_t seed)
+        : state(seed)
+        { }
+
+      /// scrambles the bits of x; also usable for deriving seeds
+      static uint64_t mix(uint64_t x)
+      {
+        x = (x ^ (x >> 30)) * ((static_cast<uint64_t>(0xbf58476d) << 32) | 0x1ce4e5b9);
+        x = (x ^ (x >> 27)) * ((static_cast<uint64_t>(0x94d049bb) << 32) | 0x133111eb);
+        return x ^ (x >> 31);
+      }
+
+      uint64_t next()
+      {
+        state += (static_cast<uint64_t>(0x9e3779b9) << 32) | 0x7f4a7c15;
+        return mix(state);
+      }
+
+      /// returns a number between 0 and n-1
+      unsigned below(unsigned n)
+        { return static_cast<unsigned>(next() % n); }
+
+      /// returns a number in [0, 1)
+      double uniform()
+        { return static_cast<double>(next() >> 11) / 9007199254740992.0; }
+  };
+}
+
+#endif // ZIM_RANDOM_H
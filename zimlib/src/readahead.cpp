@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/readahead.h>
+#include <zim/fileimpl.h>
+#include <algorithm>
+#include <stdexcept>
+#include "log.h"
+
+log_define("zim.readahead")
+
+namespace zim
+{
+  ClusterReadahead::ClusterReadahead(FileImpl& file_)
+    : file(file_),
+      depth(0),
+      last(npos),
+      next(0),
+      current(npos),
+      doneIdx(npos),
+      stop(false)
+  { }
+
+  ClusterReadahead::~ClusterReadahead()
+  {
+    {
+      MutexLock lock(mutex);
+      stop = true;
+      queue.clear();
+      workCond.signal();
+    }
+
+    join();
+  }
+
+  void ClusterReadahead::setDepth(unsigned depth_)
+  {
+    MutexLock lock(mutex);
+    log_debug("set readahead depth to " << depth_);
+    atomicSet(depth, depth_);
+    if (depth_ == 0)
+    {
+      queue.clear();
+      next = 0;
+    }
+  }
+
+  void ClusterReadahead::access(size_type idx)
+  {
+    if (atomicGet(depth) == 0)
+      return;
+
+    MutexLock lock(mutex);
+
+    if (idx != last && idx != last + 1)
+    {
+      // random access - the queued clusters are not needed any more
+      queue.clear();
+      next = 0;
+      last = idx;
+      return;
+    }
+
+    last = idx;
+
+    // the reader may have passed queued clusters already
+    while (!queue.empty() && queue.front() <= idx)
+      queue.pop_front();
+
+    size_type count = file.getCountClusters();
+    size_type end = count - idx - 1 > depth ? idx + 1 + depth : count;
+    size_type begin = std::max(idx + 1, next);
+    if (begin >= end)
+      return;
+
+    for (size_type i = begin; i < end; ++i)
+      queue.push_back(i);
+    next = end;
+
+    if (!isStarted())
+    {
+      try
+      {
+        start();
+      }
+      catch (const std::exception& e)
+      {
+        log_warn("readahead disabled: " << e.what());
+        queue.clear();
+        atomicSet(depth, 0u);
+        return;
+      }
+    }
+
+    log_debug("readahead clusters " << begin << " to " << end - 1);
+    workCond.signal();
+  }
+
+  void ClusterReadahead::cancel()
+  {
+    MutexLock lock(mutex);
+    log_debug("cancel readahead of " << queue.size() << " clusters");
+    queue.clear();
+    next = 0;
+  }
+
+  Cluster ClusterReadahead::wait(size_type idx)
+  {
+    if (atomicGet(depth) == 0)
+      return Cluster();
+
+    MutexLock lock(mutex);
+
+    std::deque<size_type>::iterator it = std::find(queue.begin(), queue.end(), idx);
+    if (it != queue.end())
+    {
+      // not started yet - the caller is faster
+      queue.erase(it);
+      return Cluster();
+    }
+
+    if (current != idx)
+      return Cluster();
+
+    log_debug("wait for readahead of cluster " << idx);
+    while (current == idx)
+      doneCond.wait(mutex);
+
+    return doneIdx == idx ? done : Cluster();
+  }
+
+  void ClusterReadahead::run()
+  {
+    mutex.lock();
+
+    while (!stop)
+    {
+      if (queue.empty())
+      {
+        workCond.wait(mutex);
+        continue;
+      }
+
+      current = queue.front();
+      queue.pop_front();
+
+      mutex.unlock();
+
+      Cluster cluster;
+      try
+      {
+        cluster = file.prefetchCluster(current);
+      }
+      catch (const std::exception& e)
+      {
+        log_warn("readahead of cluster " << current << " failed: " << e.what());
+      }
+
+      mutex.lock();
+
+      doneIdx = current;
+      done = cluster;
+      current = npos;
+      doneCond.broadcast();
+    }
+
+    mutex.unlock();
+  }
+
+}
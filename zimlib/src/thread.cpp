@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/thread.h>
+#include "log.h"
+#include <stdexcept>
+#include <sstream>
+
+log_define("zim.thread")
+
+namespace zim
+{
+#ifdef _WIN32
+  DWORD WINAPI Thread::exec(void* arg)
+  {
+    static_cast<Thread*>(arg)->run();
+    return 0;
+  }
+
+  void Thread::start()
+  {
+    handle = ::CreateThread(0, 0, exec, this, 0, 0);
+    if (handle == 0)
+    {
+      std::ostringstream msg;
+      msg << "failed to create thread; error " << ::GetLastError();
+      throw std::runtime_error(msg.str());
+    }
+
+    started = true;
+  }
+
+  void Thread::join()
+  {
+    if (started)
+    {
+      ::WaitForSingleObject(handle, INFINITE);
+      ::CloseHandle(handle);
+      started = false;
+    }
+  }
+#else
+  void* Thread::exec(void* arg)
+  {
+    static_cast<Thread*>(arg)->run();
+    return 0;
+  }
+
+  void Thread::start()
+  {
+    int ret = ::pthread_create(&thread, 0, exec, this);
+    if (ret != 0)
+    {
+      std::ostringstream msg;
+      msg << "failed to create thread; error " << ret;
+      throw std::runtime_error(msg.str());
+    }
+
+    log_debug("thread started");
+    started = true;
+  }
+
+  void Thread::join()
+  {
+    if (started)
+    {
+      ::pthread_join(thread, 0);
+      started = false;
+    }
+  }
+#endif
+
+}
@@ -18,29 +18,409 @@
  */
 
 #include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
 #include <vector>
-#include <set>
+#include <cmath>
 
-#include <stdlib.h>
-#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <zim/file.h>
 #include <zim/fileiterator.h>
 #include <zim/article.h>
 #include <zim/blob.h>
+#include <zim/thread.h>
+#include <zim/noncopyable.h>
+#include <zim/fileobserver.h>
+#include <zim/latencyhistogram.h>
 
 #include <cxxtools/loginit.h>
 #include <cxxtools/arg.h>
-#include <cxxtools/clock.h>
+
+#include "config.h"
+#include "random.h"
 
 log_define("zim.bench")
 
-std::string randomUrl()
+namespace
 {
-  std::string url;
-  for (unsigned n = 0; n < 10; ++n)
-    url += static_cast<char>('A' + rand() % 26);
-  return url;
+  enum AccessPattern
+  {
+    accessLinear,    // the articles in url order
+    accessUniform,   // random articles with equal probability
+    accessZipf       // random articles with zipf distributed popularity
+  };
+
+  const char* accessNames[] = { "linear", "uniform", "zipf" };
+
+  // Draws ranks 0..n-1, where rank r has the probability proportional to
+  // 1/(r+1)^s.
+  class ZipfDistribution
+  {
+      std::vector<double> cdf;
+
+    public:
+      ZipfDistribution(unsigned n, double s)
+        : cdf(n)
+      {
+        double sum = 0;
+        for (unsigned r = 0; r < n; ++r)
+          cdf[r] = (sum += 1.0 / std::pow(static_cast<double>(r + 1), s));
+        for (unsigned r = 0; r < n; ++r)
+          cdf[r] /= sum;
+      }
+
+      unsigned operator() (zim::Random& random) const
+      {
+        std::vector<double>::const_iterator it =
+          std::lower_bound(cdf.begin(), cdf.end(), random.uniform());
+        return it == cdf.end() ? cdf.size() - 1 : it - cdf.begin();
+      }
+  };
+
+  struct Latencies
+  {
+    zim::LatencyHistogram lookup;   // finding the article by url
+    zim::LatencyHistogram fetch;    // reading its data
+    zim::LatencyHistogram total;
+
+    void add(const Latencies& l)
+    {
+      lookup.add(l.lookup);
+      fetch.add(l.fetch);
+      total.add(l.total);
+    }
+  };
+
+  typedef std::vector<std::string> Urls;
+  typedef std::vector<unsigned> Requests;
+
+  class BenchThread : public zim::Thread
+  {
+      zim::File& file;
+      char ns;
+      const Urls& urls;
+      Requests requests;
+
+    public:
+      Latencies latencies;
+      zim::uint64_t bytes;
+      unsigned notFound;
+
+      BenchThread(zim::File& file_, char ns_, const Urls& urls_, const Requests& requests_)
+        : file(file_),
+          ns(ns_),
+          urls(urls_),
+          requests(requests_),
+          bytes(0),
+          notFound(0)
+        { }
+
+    protected:
+      void run()
+      {
+        for (Requests::const_iterator it = requests.begin(); it != requests.end(); ++it)
+        {
+          zim::uint64_t start = zim::FileObserver::now();
+          zim::Article article = file.getArticle(ns, urls[*it]);
+          zim::uint64_t found = zim::FileObserver::now();
+          if (!article.good())
+          {
+            ++notFound;
+            continue;
+          }
+
+          bytes += article.getData().size();
+          zim::uint64_t end = zim::FileObserver::now();
+
+          latencies.lookup.record(found - start);
+          latencies.fetch.record(end - found);
+          latencies.total.record(end - start);
+        }
+      }
+  };
+
+  struct Run : private zim::NonCopyable
+  {
+    AccessPattern access;
+    unsigned threads;
+    bool cold;
+
+    unsigned requests;
+    unsigned notFound;
+    zim::uint64_t bytes;
+    double seconds;
+    Latencies latencies;
+    zim::FileStats stats;     // the difference of the counters during the run
+    zim::HistogramObserver operations;
+    bool withOperations;
+
+    Run()
+      : access(accessLinear),
+        threads(1),
+        cold(false),
+        requests(0),
+        notFound(0),
+        bytes(0),
+        seconds(0),
+        withOperations(false)
+      { }
+
+    double articlesPerSecond() const
+      { return seconds > 0 ? (requests - notFound) / seconds : 0; }
+  };
+
+  double ratio(zim::uint64_t hits, zim::uint64_t misses)
+    { return hits + misses > 0 ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0; }
+
+  zim::FileStats operator- (const zim::FileStats& a, const zim::FileStats& b)
+  {
+    zim::FileStats r;
+    r.direntCacheHits = a.direntCacheHits - b.direntCacheHits;
+    r.direntCacheMisses = a.direntCacheMisses - b.direntCacheMisses;
+    r.direntCacheEvictions = a.direntCacheEvictions - b.direntCacheEvictions;
+    r.clusterCacheHits = a.clusterCacheHits - b.clusterCacheHits;
+    r.clusterCacheMisses = a.clusterCacheMisses - b.clusterCacheMisses;
+    r.clusterCacheEvictions = a.clusterCacheEvictions - b.clusterCacheEvictions;
+    r.direntBytesRead = a.direntBytesRead - b.direntBytesRead;
+    for (unsigned c = 0; c < zim::FileStats::compressionTypes; ++c)
+      r.clusterBytesRead[c] = a.clusterBytesRead[c] - b.clusterBytesRead[c];
+    r.clustersDecompressed = a.clustersDecompressed - b.clustersDecompressed;
+    r.decompressMicroseconds = a.decompressMicroseconds - b.decompressMicroseconds;
+    r.urlLookups = a.urlLookups - b.urlLookups;
+    r.titleLookups = a.titleLookups - b.titleLookups;
+    r.lookupSteps = a.lookupSteps - b.lookupSteps;
+    r.bufferPoolBytes = a.bufferPoolBytes;
+    return r;
+  }
+
+  // drops the pages of the file from the page cache
+  void dropPageCache(const std::string& filename)
+  {
+#ifdef HAVE_POSIX_FADVISE
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("cannot open " + filename);
+    int ret = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+    if (ret != 0)
+      log_warn("posix_fadvise failed with error " << ret);
+#else
+    log_warn("posix_fadvise not available; page cache of " << filename << " not dropped");
+#endif
+  }
+
+  template <typename T>
+  std::vector<T> parseList(const std::string& s)
+  {
+    std::vector<T> ret;
+    std::istringstream in(s);
+    std::string item;
+    while (std::getline(in, item, ','))
+    {
+      std::istringstream v(item);
+      T t;
+      if (!(v >> t))
+        throw std::runtime_error("invalid list \"" + s + '"');
+      ret.push_back(t);
+    }
+    return ret;
+  }
+
+  std::vector<AccessPattern> parseAccess(const std::string& s)
+  {
+    std::vector<std::string> names = parseList<std::string>(s);
+    std::vector<AccessPattern> ret;
+    for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+    {
+      unsigned a = 0;
+      while (a < 3 && *it != accessNames[a])
+        ++a;
+      if (a == 3)
+        throw std::runtime_error("unknown access pattern \"" + *it + '"');
+      ret.push_back(static_cast<AccessPattern>(a));
+    }
+    return ret;
+  }
+
+  std::vector<bool> parseCacheModes(const std::string& s)
+  {
+    std::vector<std::string> names = parseList<std::string>(s);
+    std::vector<bool> ret;
+    for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+    {
+      if (*it != "cold" && *it != "warm")
+        throw std::runtime_error("unknown cache mode \"" + *it + '"');
+      ret.push_back(*it == "cold");
+    }
+    return ret;
+  }
+
+  // collects the urls of up to count articles of the namespace, which are
+  // no redirects, in url order
+  Urls collectUrls(zim::File& file, char ns, unsigned count, zim::Random& random)
+  {
+    zim::size_type begin = file.getNamespaceBeginOffset(ns);
+    zim::size_type end = file.getNamespaceEndOffset(ns);
+    zim::size_type n = end - begin;
+
+    std::vector<zim::size_type> idx;
+    if (count >= n)
+    {
+      for (zim::size_type i = begin; i < end; ++i)
+        idx.push_back(i);
+    }
+    else
+    {
+      // sample count distinct articles (Floyd's algorithm)
+      std::vector<bool> chosen(n);
+      for (zim::size_type j = n - count; j < n; ++j)
+      {
+        zim::size_type t = random.below(j + 1);
+        if (chosen[t])
+          t = j;
+        chosen[t] = true;
+        idx.push_back(begin + t);
+      }
+      std::sort(idx.begin(), idx.end());
+    }
+
+    Urls urls;
+    for (std::vector<zim::size_type>::const_iterator it = idx.begin(); it != idx.end(); ++it)
+    {
+      zim::Dirent d = file.getDirent(*it);
+      if (!d.isRedirect() && !d.isLinktarget() && !d.isDeleted())
+        urls.push_back(d.getUrl());
+    }
+
+    return urls;
+  }
+
+  Requests createRequests(AccessPattern access, unsigned count, unsigned thread,
+    const std::vector<unsigned>& ranks, const ZipfDistribution& zipf, zim::Random& random)
+  {
+    Requests requests;
+    requests.reserve(count);
+    unsigned n = ranks.size();
+    for (unsigned r = 0; r < count; ++r)
+    {
+      switch (access)
+      {
+        case accessLinear:  requests.push_back((thread * count + r) % n); break;
+        case accessUniform: requests.push_back(random.below(n)); break;
+        case accessZipf:    requests.push_back(ranks[zipf(random)]); break;
+      }
+    }
+    return requests;
+  }
+
+  void printLatencies(std::ostream& out, const char* name, const zim::LatencyHistogram& h)
+  {
+    out << '\t' << name << " p50=" << h.getPercentile(50) / 1000.0
+        << " p90=" << h.getPercentile(90) / 1000.0
+        << " p99=" << h.getPercentile(99) / 1000.0
+        << " p999=" << h.getPercentile(99.9) / 1000.0
+        << " max=" << h.getMax() / 1000.0 << " us\n";
+  }
+
+  void printText(std::ostream& out, const Run& run)
+  {
+    out << accessNames[run.access] << " threads=" << run.threads
+        << (run.cold ? " cold" : " warm") << ":\t"
+        << run.requests << " requests, " << run.seconds << "s, "
+        << run.articlesPerSecond() << " articles/s, "
+        << run.bytes << " bytes\n";
+    printLatencies(out, "lookup", run.latencies.lookup);
+    printLatencies(out, "fetch ", run.latencies.fetch);
+    printLatencies(out, "total ", run.latencies.total);
+    out << "\tdirent cache hit ratio " << ratio(run.stats.direntCacheHits, run.stats.direntCacheMisses) * 100
+        << "%, cluster cache hit ratio " << ratio(run.stats.clusterCacheHits, run.stats.clusterCacheMisses) * 100
+        << "%, " << run.stats.clustersDecompressed << " clusters decompressed, "
+        << run.stats.bufferPoolBytes << " bytes in buffer pool\n";
+    if (run.withOperations)
+    {
+      for (unsigned op = 0; op < zim::HistogramObserver::operationCount; ++op)
+        printLatencies(out, zim::getOperationName(static_cast<zim::FileOperation>(op)),
+                       run.operations.getHistogram(static_cast<zim::FileOperation>(op)));
+    }
+    out << std::flush;
+  }
+
+  std::string jsonString(const std::string& s)
+  {
+    std::ostringstream out;
+    out << '"';
+    for (std::string::const_iterator it = s.begin(); it != s.end(); ++it)
+    {
+      unsigned char ch = static_cast<unsigned char>(*it);
+      if (ch == '"' || ch == '\\')
+        out << '\\' << *it;
+      else if (ch < 0x20)
+        out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<unsigned>(ch)
+            << std::dec << std::setfill(' ');
+      else
+        out << *it;
+    }
+    out << '"';
+    return out.str();
+  }
+
+  void printJson(std::ostream& out, const zim::LatencyHistogram& h)
+  {
+    out << "{\"count\": " << h.getCount()
+        << ", \"mean\": " << h.getMean()
+        << ", \"min\": " << h.getMin()
+        << ", \"p50\": " << h.getPercentile(50)
+        << ", \"p90\": " << h.getPercentile(90)
+        << ", \"p99\": " << h.getPercentile(99)
+        << ", \"p999\": " << h.getPercentile(99.9)
+        << ", \"max\": " << h.getMax() << '}';
+  }
+
+  void printJson(std::ostream& out, const Run& run)
+  {
+    out << "    {\n"
+           "      \"access\": \"" << accessNames[run.access] << "\",\n"
+           "      \"threads\": " << run.threads << ",\n"
+           "      \"cache\": \"" << (run.cold ? "cold" : "warm") << "\",\n"
+           "      \"requests\": " << run.requests << ",\n"
+           "      \"notFound\": " << run.notFound << ",\n"
+           "      \"bytes\": " << run.bytes << ",\n"
+           "      \"seconds\": " << run.seconds << ",\n"
+           "      \"articlesPerSecond\": " << run.articlesPerSecond() << ",\n"
+           "      \"lookupNs\": "; printJson(out, run.latencies.lookup); out << ",\n"
+           "      \"fetchNs\": "; printJson(out, run.latencies.fetch); out << ",\n"
+           "      \"totalNs\": "; printJson(out, run.latencies.total); out << ",\n"
+           "      \"direntCacheHits\": " << run.stats.direntCacheHits << ",\n"
+           "      \"direntCacheMisses\": " << run.stats.direntCacheMisses << ",\n"
+           "      \"direntCacheHitRatio\": " << ratio(run.stats.direntCacheHits, run.stats.direntCacheMisses) << ",\n"
+           "      \"clusterCacheHits\": " << run.stats.clusterCacheHits << ",\n"
+           "      \"clusterCacheMisses\": " << run.stats.clusterCacheMisses << ",\n"
+           "      \"clusterCacheHitRatio\": " << ratio(run.stats.clusterCacheHits, run.stats.clusterCacheMisses) << ",\n"
+           "      \"direntBytesRead\": " << run.stats.direntBytesRead << ",\n"
+           "      \"clusterBytesRead\": " << run.stats.getClusterBytesRead() << ",\n"
+           "      \"clustersDecompressed\": " << run.stats.clustersDecompressed << ",\n"
+           "      \"decompressMicroseconds\": " << run.stats.decompressMicroseconds << ",\n"
+           "      \"bufferPoolBytes\": " << run.stats.bufferPoolBytes;
+
+    if (run.withOperations)
+    {
+      out << ",\n"
+             "      \"operationsNs\": {";
+      for (unsigned op = 0; op < zim::HistogramObserver::operationCount; ++op)
+      {
+        out << (op > 0 ? ",\n" : "\n")
+            << "        \"" << zim::getOperationName(static_cast<zim::FileOperation>(op)) << "\": ";
+        printJson(out, run.operations.getHistogram(static_cast<zim::FileOperation>(op)));
+      }
+      out << "\n      }";
+    }
+
+    out << "\n    }";
+  }
 }
 
 int main(int argc, char* argv[])
@@ -49,92 +429,161 @@ int main(int argc, char* argv[])
   {
     log_init();
 
-    cxxtools::Arg<unsigned> count(argc, argv, 'n', 1000);   // number of linear accessed articles
-    cxxtools::Arg<unsigned> randomCount(argc, argv, 'r', count);  // number of random accesses
-    cxxtools::Arg<unsigned> distinctCount(argc, argv, 'd', randomCount);  // number of distinct articles used for random access
+    cxxtools::Arg<unsigned> count(argc, argv, 'n', 1000);         // requests per thread and run
+    cxxtools::Arg<unsigned> distinctCount(argc, argv, 'd', 100000); // number of distinct articles used
+    cxxtools::Arg<std::string> threadList(argc, argv, 't', "1");
+    cxxtools::Arg<std::string> accessList(argc, argv, 'a', "linear,uniform,zipf");
+    cxxtools::Arg<std::string> cacheList(argc, argv, 'c', "cold,warm");
+    cxxtools::Arg<double> zipfExponent(argc, argv, 's', 0.99);
+    cxxtools::Arg<unsigned> seed(argc, argv, "--seed", 1);
     cxxtools::Arg<char> ns(argc, argv, "--ns", 'A');
+    cxxtools::Arg<bool> operations(argc, argv, 'o');
+    cxxtools::Arg<bool> json(argc, argv, 'j');
 
     if (argc != 2)
     {
       std::cerr << "usage: " << argv[0] << " [options] zimfile\n"
-                   "\t-n number\tnumber of linear accessed articles (default 1000)\n"
-                   "\t-r number\tnumber of random accessed articles (default: same as -n)\n"
-                   "\t-d number\tnumber of distinct articles used for random access (default: same as -r)\n"
+                   "\t-n number\tnumber of requests per thread and run (default 1000)\n"
+                   "\t-d number\tnumber of distinct articles used (default 100000)\n"
+                   "\t-t list\t\tcomma separated thread counts (default 1)\n"
+                   "\t-a list\t\taccess patterns linear, uniform and zipf (default all)\n"
+                   "\t-c list\t\tcache modes cold and warm (default both)\n"
+                   "\t-s number\texponent of the zipf distribution (default 0.99)\n"
+                   "\t--seed number\tseed of the random numbers (default 1)\n"
+                   "\t--ns char\tnamespace of the articles (default A)\n"
+                   "\t-o\t\tmeasure the latencies of the library operations\n"
+                   "\t-j\t\tprint the results as json\n"
+                   "\n"
+                   "Cold runs reopen the file and drop it from the page cache before\n"
+                   "running; warm runs request the same articles once before measuring.\n"
                 << std::flush;
       return 1;
     }
 
-    srand(time(0));
-
     std::string filename = argv[1];
+    std::vector<unsigned> threadCounts = parseList<unsigned>(threadList);
+    std::vector<AccessPattern> accessPatterns = parseAccess(accessList);
+    std::vector<bool> cacheModes = parseCacheModes(cacheList);
+
+    std::ostream& progress = json ? std::cerr : std::cout;
 
-    std::cout << "open file " << filename << std::endl;
+    progress << "open file " << filename << std::endl;
     zim::File file(filename);
 
-    // collect urls
-    typedef std::set<std::string> UrlsType;
-    typedef std::vector<std::string> RandomUrlsType;
-    UrlsType urls;
-    RandomUrlsType randomUrls;
+    zim::Random random(seed);
+    Urls urls = collectUrls(file, ns, distinctCount, random);
+    if (urls.empty())
+      throw std::runtime_error(std::string("no articles found in namespace ") + static_cast<char>(ns));
+    progress << urls.size() << " urls collected" << std::endl;
 
-    std::cout << "collect linear urls" << std::endl;
-    for (zim::File::const_iterator it = file.begin(); it != file.end() && urls.size() < count; ++it)
-    {
-      log_debug("check url " << it->getUrl() << '\t' << urls.size() << " found");
-      if (!it->isRedirect())
-        urls.insert(it->getUrl());
-    }
+    // the popularity of the urls for zipf is independent of their order
+    std::vector<unsigned> ranks(urls.size());
+    for (unsigned r = 0; r < ranks.size(); ++r)
+      ranks[r] = r;
+    for (unsigned r = ranks.size(); r > 1; --r)
+      std::swap(ranks[r - 1], ranks[random.below(r)]);
+    ZipfDistribution zipf(urls.size(), zipfExponent);
 
-    std::cout << urls.size() << " urls collected" << std::endl;
+    std::vector<Run*> runs;
 
-    std::cout << "collect random urls" << std::endl;
-    while (randomUrls.size() < distinctCount)
+    for (std::vector<AccessPattern>::const_iterator a = accessPatterns.begin(); a != accessPatterns.end(); ++a)
+    for (std::vector<unsigned>::const_iterator t = threadCounts.begin(); t != threadCounts.end(); ++t)
+    for (std::vector<bool>::const_iterator c = cacheModes.begin(); c != cacheModes.end(); ++c)
     {
-      zim::File::const_iterator it = file.find(ns, randomUrl());
-      log_debug("check url " << it->getUrl() << '\t' << randomUrls.size() << " found");
-      if (!it->isRedirect())
-        randomUrls.push_back(it->getUrl());
-    }
+      Run* r = new Run();
+      runs.push_back(r);
+      Run& run = *r;
+      run.access = *a;
+      run.threads = *t > 0 ? *t : 1;
+      run.cold = *c;
+
+      // the same requests for every cache mode
+      zim::Random requestRandom(seed + run.access * 1000 + run.threads);
+      std::vector<Requests> requests;
+      for (unsigned n = 0; n < run.threads; ++n)
+        requests.push_back(createRequests(run.access, count, n, ranks, zipf, requestRandom));
 
-    std::cout << randomUrls.size() << " random urls collected" << std::endl;
+      file = zim::File();
+      if (run.cold)
+        dropPageCache(filename);
+      file = zim::File(filename);
 
-    // reopen file
-    file = zim::File();
-    file = zim::File(filename);
+      if (!run.cold)
+      {
+        for (std::vector<Requests>::const_iterator r = requests.begin(); r != requests.end(); ++r)
+        {
+          BenchThread warmup(file, ns, urls, *r);
+          warmup.start();
+          warmup.join();
+        }
+      }
 
-    // linear read
-    std::cout << "linear:" << std::flush;
-    cxxtools::Clock clock;
-    clock.start();
+      if (operations)
+      {
+        run.withOperations = true;
+        file.setObserver(&run.operations);
+      }
 
-    unsigned size = 0;
-    for (UrlsType::const_iterator it = urls.begin(); it != urls.end(); ++it)
-      size += file.getArticle(ns, *it).getData().size();
+      if (json)
+        std::cerr << accessNames[run.access] << " threads=" << run.threads
+                  << (run.cold ? " cold" : " warm") << std::endl;
 
-    cxxtools::Timespan t = clock.stop();
-    std::cout << "\tsize=" << size << "\tt=" << (t.totalMSecs() / 1000.0) << "s\t" << (static_cast<double>(urls.size()) / t.totalMSecs() * 1000.0) << " articles/s" << std::endl;
+      zim::FileStats before = file.getStats();
 
-    // reopen file
-    file = zim::File();
-    file = zim::File(filename);
+      std::vector<BenchThread*> threads;
+      for (unsigned n = 0; n < run.threads; ++n)
+        threads.push_back(new BenchThread(file, ns, urls, requests[n]));
 
-    // random access
-    std::cout << "random:" << std::flush;
-    clock.start();
+      zim::uint64_t start = zim::FileObserver::now();
+      for (unsigned n = 0; n < run.threads; ++n)
+        threads[n]->start();
+      for (unsigned n = 0; n < run.threads; ++n)
+        threads[n]->join();
+      run.seconds = (zim::FileObserver::now() - start) / 1e9;
 
-    size = 0;
-    for (unsigned r = 0; r < randomCount; ++r)
-      size += file.getArticle(ns, randomUrls[rand() % randomUrls.size()]).getData().size();
+      file.setObserver(0);
+      run.stats = file.getStats() - before;
 
-    //for (UrlsType::const_iterator it = randomUrls.begin(); it != randomUrls.end(); ++it)
-      //size += file.getArticle(ns, *it).getData().size();
+      for (unsigned n = 0; n < run.threads; ++n)
+      {
+        run.requests += count;
+        run.notFound += threads[n]->notFound;
+        run.bytes += threads[n]->bytes;
+        run.latencies.add(threads[n]->latencies);
+        delete threads[n];
+      }
 
-    t = clock.stop();
-    std::cout << "\tsize=" << size << "\tt=" << (t.totalMSecs() / 1000.0) << "s\t" << (static_cast<double>(randomCount) / t.totalMSecs() * 1000.0) << " articles/s" << std::endl;
+      if (!json)
+        printText(std::cout, run);
+    }
+
+    if (json)
+    {
+      std::cout << "{\n"
+                   "  \"file\": " << jsonString(filename) << ",\n"
+                   "  \"articles\": " << file.getCountArticles() << ",\n"
+                   "  \"distinctArticles\": " << urls.size() << ",\n"
+                   "  \"requestsPerThread\": " << static_cast<unsigned>(count) << ",\n"
+                   "  \"zipfExponent\": " << static_cast<double>(zipfExponent) << ",\n"
+                   "  \"seed\": " << static_cast<unsigned>(seed) << ",\n"
+                   "  \"direntCachePolicy\": \"" << zim::getCachePolicyName(file.getDirentCachePolicy()) << "\",\n"
+                   "  \"clusterCachePolicy\": \"" << zim::getCachePolicyName(file.getClusterCachePolicy()) << "\",\n"
+                   "  \"runs\": [";
+      for (std::vector<Run*>::const_iterator it = runs.begin(); it != runs.end(); ++it)
+      {
+        std::cout << (it == runs.begin() ? "\n" : ",\n");
+        printJson(std::cout, **it);
+      }
+      std::cout << "\n  ]\n"
+                   "}" << std::endl;
+    }
+
+    for (std::vector<Run*>::iterator it = runs.begin(); it != runs.end(); ++it)
+      delete *it;
   }
   catch (const std::exception& e)
   {
     std::cerr << e.what() << std::endl;
+    return 1;
   }
 }
-
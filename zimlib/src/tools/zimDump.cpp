@@ -83,6 +83,10 @@ void ZimDumper::printInfo()
                "title idx pos: " << file.getFileheader().getTitleIdxPos() << "\n"
                "cluster count: " << file.getFileheader().getClusterCount() << "\n"
                "cluster ptr pos: " << file.getFileheader().getClusterPtrPos() << "\n";
+  if (file.getFileheader().hasClusterInfo())
+    std::cout <<
+               "minor version: " << file.getFileheader().getMinorVersion() << "\n"
+               "cluster info pos: " << file.getFileheader().getClusterInfoPos() << "\n";
   if (file.getFileheader().hasChecksum())
     std::cout <<
                "checksum pos: " << file.getFileheader().getChecksumPos() << "\n"
@@ -396,8 +400,12 @@ void ZimDumper::dumpFiles(const std::string& directory)
 {
   ::mkdir(directory.c_str(), 0777);
 
+  // when all articles are dumped, they are read in cluster order, so that
+  // each cluster is uncompressed just once
+  zim::File::const_iterator begin = pos.getIndex() == 0 ? file.beginByCluster() : pos;
+
   std::set<char> ns;
-  for (zim::File::const_iterator it = pos; it != file.end(); ++it)
+  for (zim::File::const_iterator it = begin; it != file.end(); ++it)
   {
     std::string d = directory + '/' + it->getNamespace();
     if (ns.find(it->getNamespace()) == ns.end())
@@ -0,0 +1,679 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+/*
+   Generates zim files with synthetic articles for performance tests.
+
+   The properties of article n (namespace, redirect, mime type, title, size
+   and data) are derived from the seed and n only, so a file is reproduced
+   exactly with the same options on every machine. The urls start with the
+   number of the article in its namespace, so that the final index of each
+   article is known while generating and the optional full text index
+   (namespace X) can refer to it.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+#include <map>
+#include <set>
+#include <cmath>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <zim/writer/zimcreator.h>
+#include <zim/writer/articlesource.h>
+#include <zim/blob.h>
+#include <zim/endian.h>
+#include "arg.h"
+#include "log.h"
+#include "random.h"
+
+log_define("zim.gen")
+
+namespace
+{
+  // random numbers for one purpose of one article
+  class Random : public zim::Random
+  {
+    public:
+      Random(zim::uint64_t seed, zim::uint64_t n, unsigned purpose)
+        : zim::Random(mix(seed ^ mix(n * 8 + purpose)))
+        { }
+
+      /// returns a normal distributed number (Box-Muller)
+      double normal()
+      {
+        double u = uniform();
+        double v = uniform();
+        return std::sqrt(-2 * std::log(1 - u)) * std::cos(6.283185307179586 * v);
+      }
+  };
+
+  enum Purpose
+  {
+    purposeNamespace,
+    purposeRedirect,
+    purposeContent,
+    purposeVocabulary,
+    purposeUuid
+  };
+
+  // a weighted choice between values
+  template <typename T>
+  class Mix
+  {
+      std::vector<T> values;
+      std::vector<double> cdf;
+
+    public:
+      void add(const T& value, double weight)
+      {
+        if (weight <= 0)
+          return;
+        values.push_back(value);
+        cdf.push_back((cdf.empty() ? 0 : cdf.back()) + weight);
+      }
+
+      bool empty() const   { return values.empty(); }
+      const std::vector<T>& getValues() const  { return values; }
+
+      const T& choose(Random& random) const
+      {
+        double r = random.uniform() * cdf.back();
+        typename std::vector<double>::const_iterator it = std::upper_bound(cdf.begin(), cdf.end(), r);
+        return values[it == cdf.end() ? values.size() - 1 : it - cdf.begin()];
+      }
+  };
+
+  // Splits "value:weight,value:weight" into its entries. The weight is
+  // separated by the last colon.
+  std::vector<std::pair<std::string, double> > parseMix(const std::string& spec)
+  {
+    std::vector<std::pair<std::string, double> > ret;
+    std::istringstream in(spec);
+    std::string item;
+    while (std::getline(in, item, ','))
+    {
+      std::string::size_type p = item.rfind(':');
+      double weight = 0;
+      if (p == std::string::npos || p == 0 || !(std::istringstream(item.substr(p + 1)) >> weight))
+        throw std::runtime_error("invalid entry \"" + item + "\" in \"" + spec + '"');
+      ret.push_back(std::make_pair(item.substr(0, p), weight));
+    }
+    return ret;
+  }
+
+  // log normal distributed sizes given by "median:sigma"
+  struct SizeDistribution
+  {
+    double median;
+    double sigma;
+
+    explicit SizeDistribution(const std::string& spec)
+      : median(0),
+        sigma(0)
+    {
+      char colon = ':';
+      std::istringstream in(spec);
+      if (!(in >> median) || (in >> colon && (colon != ':' || !(in >> sigma))) || median < 1)
+        throw std::runtime_error("invalid size distribution \"" + spec + '"');
+    }
+
+    unsigned operator() (Random& random) const
+    {
+      static const double maxSize = 16 * 1024 * 1024;
+      double s = median * std::exp(sigma * random.normal());
+      return static_cast<unsigned>(s < 1 ? 1 : s > maxSize ? maxSize : s);
+    }
+  };
+
+  bool isTextMimeType(const std::string& mimeType)
+  {
+    return mimeType.compare(0, 5, "text/") == 0
+        || mimeType.find("javascript") != std::string::npos
+        || mimeType.find("json") != std::string::npos
+        || mimeType.find("xml") != std::string::npos;
+  }
+
+  class SyntheticArticle : public zim::writer::Article
+  {
+    public:
+      std::string aid;
+      char ns;
+      std::string url;
+      std::string title;
+      std::string mimeType;
+      std::string redirectAid;
+      std::string data;
+      bool compress;
+
+      std::string getAid() const           { return aid; }
+      char getNamespace() const            { return ns; }
+      std::string getUrl() const           { return url; }
+      std::string getTitle() const         { return title; }
+      bool isRedirect() const              { return !redirectAid.empty(); }
+      std::string getMimeType() const      { return mimeType; }
+      std::string getRedirectAid() const   { return redirectAid; }
+      bool shouldCompress() const          { return compress; }
+      zim::Blob getData() const            { return zim::Blob(data.data(), data.size()); }
+  };
+
+  struct IndexEntry
+  {
+    zim::size_type index;
+    zim::size_type pos;
+
+    IndexEntry(zim::size_type index_, zim::size_type pos_)
+      : index(index_),
+        pos(pos_)
+      { }
+  };
+
+  // the entries of a word in the 4 categories of the full text index
+  struct IndexWord
+  {
+    std::vector<IndexEntry> entries[4];
+  };
+
+  class SyntheticSource : public zim::writer::ArticleSource
+  {
+    public:
+      struct Options
+      {
+        unsigned count;
+        double redirectRatio;
+        std::string namespaces;
+        std::string mimeTypes;
+        std::string textSize;
+        std::string binarySize;
+        unsigned words;
+        bool index;
+        unsigned indexWords;
+        zim::uint64_t seed;
+
+        // settings of the creator, which change the file as well
+        unsigned minChunkSize;
+        zim::CompressionType compression;
+        bool clusterInfo;
+      };
+
+    private:
+      Options options;
+
+      Mix<char> namespaceMix;
+      std::map<char, Mix<std::string> > mimeMix;
+      SizeDistribution textSize;
+      SizeDistribution binarySize;
+
+      std::vector<std::string> vocabulary;
+      std::vector<double> wordCdf;
+
+      // the number of articles in each namespace and the index of the first
+      unsigned nsCount[256];
+      unsigned nsOffset[256];
+      unsigned nsNext[256];
+
+      std::vector<IndexWord> index;
+
+      unsigned next;
+      std::string mainPage;
+      SyntheticArticle article;
+
+      zim::uint64_t textBytes;
+      zim::uint64_t binaryBytes;
+      unsigned redirects;
+
+      char getArticleNamespace(unsigned n) const
+      {
+        Random random(options.seed, n, purposeNamespace);
+        return namespaceMix.choose(random);
+      }
+
+      bool isRedirect(unsigned n) const
+      {
+        if (n == 0)
+          return false;
+        Random random(options.seed, n, purposeRedirect);
+        return random.uniform() < options.redirectRatio;
+      }
+
+      unsigned redirectTarget(unsigned n) const
+      {
+        Random random(options.seed, n, purposeRedirect);
+        random.next();
+        unsigned m = random.below(n);
+        while (isRedirect(m))
+          --m;
+        return m;
+      }
+
+      unsigned chooseWordIdx(Random& random) const
+      {
+        std::vector<double>::const_iterator it =
+          std::lower_bound(wordCdf.begin(), wordCdf.end(), random.uniform());
+        return it == wordCdf.end() ? vocabulary.size() - 1 : it - wordCdf.begin();
+      }
+
+      void createVocabulary();
+      void countNamespaces();
+      void createArticle(unsigned n);
+      void createIndexArticle(unsigned w);
+      void addToIndex(zim::size_type idx, unsigned cat, const std::vector<unsigned>& words);
+
+    public:
+      explicit SyntheticSource(const Options& options);
+
+      const zim::writer::Article* getNextArticle();
+      zim::Uuid getUuid();
+      std::string getMainPage()   { return mainPage; }
+
+      void printSummary(std::ostream& out) const;
+  };
+
+  SyntheticSource::SyntheticSource(const Options& options_)
+    : options(options_),
+      textSize(options_.textSize),
+      binarySize(options_.binarySize),
+      next(0),
+      textBytes(0),
+      binaryBytes(0),
+      redirects(0)
+  {
+    if (options.count >= 1000000000)
+      throw std::runtime_error("too many articles");
+
+    std::vector<std::pair<std::string, double> > ns = parseMix(options.namespaces);
+    for (unsigned i = 0; i < ns.size(); ++i)
+    {
+      if (ns[i].first.size() != 1)
+        throw std::runtime_error("invalid namespace \"" + ns[i].first + '"');
+      if (options.index && ns[i].first[0] == 'X')
+        throw std::runtime_error("namespace X is used for the full text index");
+      namespaceMix.add(ns[i].first[0], ns[i].second);
+    }
+    if (namespaceMix.empty())
+      throw std::runtime_error("no namespace");
+
+    // mime types are given as "mimetype:weight" for all namespaces or as
+    // "ns=mimetype:weight" for a single namespace
+    std::vector<std::pair<std::string, double> > mt = parseMix(options.mimeTypes);
+    Mix<std::string> defaultMix;
+    for (unsigned i = 0; i < mt.size(); ++i)
+    {
+      if (mt[i].first.size() > 2 && mt[i].first[1] == '=')
+        mimeMix[mt[i].first[0]].add(mt[i].first.substr(2), mt[i].second);
+      else
+        defaultMix.add(mt[i].first, mt[i].second);
+    }
+
+    const std::vector<char>& nsValues = namespaceMix.getValues();
+    for (unsigned i = 0; i < nsValues.size(); ++i)
+    {
+      if (mimeMix[nsValues[i]].empty())
+      {
+        if (defaultMix.empty())
+          throw std::runtime_error(std::string("no mime type for namespace ") + nsValues[i]);
+        mimeMix[nsValues[i]] = defaultMix;
+      }
+    }
+
+    createVocabulary();
+    countNamespaces();
+
+    if (options.index)
+      index.resize(vocabulary.size());
+  }
+
+  // creates distinct lower case pseudo words; their frequency in the text
+  // follows zipf's law like in natural language, so that the text
+  // compresses similar
+  void SyntheticSource::createVocabulary()
+  {
+    static const char consonants[] = "bcdfghjklmnprstvwz";
+    static const char vowels[] = "aeiou";
+
+    Random random(options.seed, 0, purposeVocabulary);
+    std::set<std::string> seen;
+    while (vocabulary.size() < options.words)
+    {
+      std::string word;
+      unsigned syllables = 1 + random.below(3) + random.below(2);
+      for (unsigned s = 0; s < syllables; ++s)
+      {
+        word += consonants[random.below(sizeof(consonants) - 1)];
+        word += vowels[random.below(sizeof(vowels) - 1)];
+        if (random.below(3) == 0)
+          word += consonants[random.below(sizeof(consonants) - 1)];
+      }
+
+      if (seen.insert(word).second)
+        vocabulary.push_back(word);
+    }
+
+    double sum = 0;
+    wordCdf.resize(vocabulary.size());
+    for (unsigned w = 0; w < vocabulary.size(); ++w)
+      wordCdf[w] = (sum += 1.0 / (w + 1));
+    for (unsigned w = 0; w < vocabulary.size(); ++w)
+      wordCdf[w] /= sum;
+  }
+
+  // The articles are sorted by namespace and url. Since the urls start with
+  // the number of the article in its namespace, the index of an article is
+  // the offset of its namespace plus this number.
+  void SyntheticSource::countNamespaces()
+  {
+    std::fill(nsCount, nsCount + 256, 0);
+    std::fill(nsNext, nsNext + 256, 0);
+
+    for (unsigned n = 0; n < options.count; ++n)
+      ++nsCount[static_cast<unsigned char>(getArticleNamespace(n))];
+    if (options.index)
+      nsCount[static_cast<unsigned char>('X')] += vocabulary.size();
+
+    unsigned offset = 0;
+    for (unsigned c = 0; c < 256; ++c)
+    {
+      nsOffset[c] = offset;
+      offset += nsCount[c];
+    }
+  }
+
+  void SyntheticSource::addToIndex(zim::size_type idx, unsigned cat, const std::vector<unsigned>& words)
+  {
+    // one entry for the first position of each word
+    for (unsigned pos = 0; pos < words.size(); ++pos)
+    {
+      if (std::find(words.begin(), words.begin() + pos, words[pos]) == words.begin() + pos)
+        index[words[pos]].entries[cat].push_back(IndexEntry(idx, pos));
+    }
+  }
+
+  void SyntheticSource::createArticle(unsigned n)
+  {
+    Random random(options.seed, n, purposeContent);
+
+    article.ns = getArticleNamespace(n);
+    unsigned char nsIdx = static_cast<unsigned char>(article.ns);
+    unsigned k = nsNext[nsIdx]++;
+
+    std::ostringstream aid;
+    aid << n;
+    article.aid = aid.str();
+
+    // the title consists of some words followed by the number, so that it
+    // is unique; the url is the number padded to a fixed size followed by
+    // the words
+    char number[16];
+    std::sprintf(number, "%09u", k);
+    article.url = number;
+    article.title.clear();
+
+    std::vector<unsigned> titleWords;
+    unsigned titleLength = 1 + random.below(4);
+    for (unsigned w = 0; w < titleLength; ++w)
+    {
+      titleWords.push_back(chooseWordIdx(random));
+      std::string word = vocabulary[titleWords.back()];
+      word[0] = static_cast<char>(std::toupper(word[0]));
+      article.url += '_';
+      article.url += word;
+      article.title += word;
+      article.title += ' ';
+    }
+    article.title += number + std::strspn(number, "0");
+    if (k == 0)
+      article.title += '0';
+
+    article.data.clear();
+    article.redirectAid.clear();
+
+    if (isRedirect(n))
+    {
+      std::ostringstream target;
+      target << redirectTarget(n);
+      article.redirectAid = target.str();
+      article.mimeType.clear();
+      article.compress = false;
+      ++redirects;
+      return;
+    }
+
+    article.mimeType = mimeMix[article.ns].choose(random);
+    bool text = isTextMimeType(article.mimeType);
+    article.compress = text;
+
+    if (text)
+    {
+      unsigned size = textSize(random);
+      bool html = article.mimeType == "text/html";
+      bool indexed = options.index && article.ns == 'A';
+      std::vector<unsigned> bodyWords;
+
+      if (html)
+        article.data = "<html><head><title>" + article.title + "</title></head>\n<body><h1>"
+                     + article.title + "</h1>\n<p>";
+
+      unsigned wordsInParagraph = 0;
+      while (article.data.size() < size)
+      {
+        unsigned w = chooseWordIdx(random);
+        if (indexed && bodyWords.size() < options.indexWords)
+          bodyWords.push_back(w);
+
+        if (wordsInParagraph > 0)
+          article.data += ' ';
+        article.data += vocabulary[w];
+
+        if (++wordsInParagraph > 40 && random.below(20) == 0)
+        {
+          article.data += html ? ".</p>\n<p>" : ".\n";
+          wordsInParagraph = 0;
+        }
+      }
+
+      if (html)
+        article.data += "</p>\n</body></html>\n";
+
+      if (indexed)
+      {
+        zim::size_type idx = nsOffset[nsIdx] + k;
+        addToIndex(idx, 0, titleWords);
+        addToIndex(idx, 3, bodyWords);
+      }
+
+      textBytes += article.data.size();
+    }
+    else
+    {
+      unsigned size = binarySize(random);
+      article.data.resize(size);
+      for (unsigned i = 0; i < size; i += 8)
+      {
+        zim::uint64_t r = random.next();
+        for (unsigned j = 0; j < 8 && i + j < size; ++j, r >>= 8)
+          article.data[i + j] = static_cast<char>(r);
+      }
+
+      binaryBytes += article.data.size();
+    }
+
+    if (mainPage.empty() && article.ns == 'A' && article.mimeType == "text/html")
+      mainPage = article.aid;
+  }
+
+  // The index article of a word in the format read by IndexArticle: the
+  // number of entries in each of the 4 categories followed by the article
+  // index and position of the entries.
+  void SyntheticSource::createIndexArticle(unsigned w)
+  {
+    const std::string& word = vocabulary[w];
+    const IndexWord& entries = index[w];
+
+    article.ns = 'X';
+    article.aid = "X/" + word;
+    article.url = word;
+    article.title = word;
+    article.mimeType = "application/octet-stream";
+    article.redirectAid.clear();
+    article.compress = true;
+    article.data.clear();
+
+    for (unsigned cat = 0; cat < 4; ++cat)
+    {
+      zim::size_type v = entries.entries[cat].size();
+      v = zim::fromLittleEndian(&v);
+      article.data.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+
+    for (unsigned cat = 0; cat < 4; ++cat)
+    {
+      for (std::vector<IndexEntry>::const_iterator it = entries.entries[cat].begin(); it != entries.entries[cat].end(); ++it)
+      {
+        zim::size_type v[2] = { it->index, it->pos };
+        v[0] = zim::fromLittleEndian(&v[0]);
+        v[1] = zim::fromLittleEndian(&v[1]);
+        article.data.append(reinterpret_cast<const char*>(v), sizeof(v));
+      }
+    }
+
+    // the entries are not needed any more
+    index[w] = IndexWord();
+  }
+
+  const zim::writer::Article* SyntheticSource::getNextArticle()
+  {
+    if (next < options.count)
+      createArticle(next);
+    else if (options.index && next - options.count < vocabulary.size())
+      createIndexArticle(next - options.count);
+    else
+      return 0;
+
+    ++next;
+    return &article;
+  }
+
+  zim::Uuid SyntheticSource::getUuid()
+  {
+    // Files generated with the same options are identical, so the uuid is
+    // a hash of all options. Files differing in any option get different
+    // uuids and do not share caches keyed by uuid.
+    std::ostringstream s;
+    s << options.count << ' ' << options.redirectRatio << ' ' << options.namespaces
+      << ' ' << options.mimeTypes << ' ' << options.textSize << ' ' << options.binarySize
+      << ' ' << options.words << ' ' << options.index << ' ' << options.indexWords
+      << ' ' << options.minChunkSize << ' ' << static_cast<unsigned>(options.compression)
+      << ' ' << options.clusterInfo;
+    std::string desc = s.str();
+
+    zim::uint64_t h = 0;
+    for (std::string::const_iterator it = desc.begin(); it != desc.end(); ++it)
+      h = zim::Random::mix(h ^ static_cast<unsigned char>(*it));
+
+    Random random(options.seed ^ h, 0, purposeUuid);
+    char data[16];
+    for (unsigned i = 0; i < 16; i += 8)
+    {
+      zim::uint64_t r = random.next();
+      for (unsigned j = 0; j < 8; ++j, r >>= 8)
+        data[i + j] = static_cast<char>(r);
+    }
+    return zim::Uuid(data);
+  }
+
+  void SyntheticSource::printSummary(std::ostream& out) const
+  {
+    out << options.count << " articles, " << redirects << " redirects\n";
+    for (unsigned c = 0; c < 256; ++c)
+      if (nsCount[c] > 0)
+        out << "namespace " << static_cast<char>(c) << ": " << nsCount[c] << " articles\n";
+    out << textBytes << " bytes of text, " << binaryBytes << " bytes of binary data" << std::endl;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    SyntheticSource::Options options;
+    options.count = zim::Arg<unsigned>(argc, argv, 'n', 10000);
+    options.redirectRatio = zim::Arg<double>(argc, argv, 'r', 0.1);
+    options.namespaces = zim::Arg<std::string>(argc, argv, "--ns", "A:90,I:8,-:2").getValue();
+    options.mimeTypes = zim::Arg<std::string>(argc, argv, "--mime",
+      "text/html:100,I=image/png:60,I=image/jpeg:40,-=text/css:50,-=application/javascript:50").getValue();
+    options.textSize = zim::Arg<std::string>(argc, argv, "--text-size", "6000:1").getValue();
+    options.binarySize = zim::Arg<std::string>(argc, argv, "--binary-size", "20000:1.5").getValue();
+    options.words = zim::Arg<unsigned>(argc, argv, "--words", 4096);
+    options.index = zim::Arg<bool>(argc, argv, 'x');
+    options.indexWords = zim::Arg<unsigned>(argc, argv, "--index-words", 16);
+    options.seed = zim::Arg<unsigned>(argc, argv, "--seed", 1);
+
+    zim::writer::ZimCreator creator(argc, argv);
+    options.minChunkSize = creator.getMinChunkSize();
+    options.compression = creator.getCompression();
+    options.clusterInfo = creator.getClusterInfo();
+
+    if (argc != 2)
+    {
+      std::cerr << "usage: " << argv[0] << " [options] output.zim\n"
+                   "\n"
+                   "Generates a zim file with synthetic articles. The output is the same\n"
+                   "for the same options.\n"
+                   "\n"
+                   "options:\n"
+                   "\t-n number\t\tnumber of articles (default 10000)\n"
+                   "\t-r ratio\t\tratio of redirects (default 0.1)\n"
+                   "\t--ns mix\t\tnamespaces with weights (default A:90,I:8,-:2)\n"
+                   "\t--mime mix\t\tmime types with weights; \"ns=type:weight\" applies to a\n"
+                   "\t\t\t\tnamespace only (default text/html:100,I=image/png:60,\n"
+                   "\t\t\t\tI=image/jpeg:40,-=text/css:50,-=application/javascript:50)\n"
+                   "\t--text-size m:s\t\tlog normal size of text data with median m and\n"
+                   "\t\t\t\tsigma s (default 6000:1)\n"
+                   "\t--binary-size m:s\tsize of binary data (default 20000:1.5)\n"
+                   "\t--words number\t\tsize of the vocabulary (default 4096)\n"
+                   "\t-x\t\t\tcreate a full text index in namespace X\n"
+                   "\t--index-words number\tnumber of words of each article in the index (default 16)\n"
+                   "\t--seed number\t\tseed of the random numbers (default 1)\n"
+                   "\t-s number\t\tminimum cluster size in kB (default 960)\n"
+                   "\t--zlib, --bzip2, --lzma\tcompression\n"
+                   "\t--cluster-info\t\twrite the cluster info table\n"
+                << std::flush;
+      return 1;
+    }
+
+    if (options.redirectRatio < 0 || options.redirectRatio >= 1)
+      throw std::runtime_error("redirect ratio must be between 0 and 1");
+    if (options.words < 1)
+      throw std::runtime_error("vocabulary is empty");
+
+    SyntheticSource source(options);
+    creator.create(argv[1], source);
+    source.printSummary(std::cout);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,363 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <map>
+#include <limits>
+#include <zim/accesstrace.h>
+#include <zim/cachepolicy.h>
+#include "arg.h"
+#include "log.h"
+
+log_define("zim.tracesim")
+
+namespace
+{
+  // what is known from the trace about a dirent or cluster
+  struct ObjectInfo
+  {
+    zim::size_type bytes;      // bytes read from the file on a miss
+    zim::size_type memBytes;   // memory used in the cache
+    zim::uint64_t usecs;       // total time to read it
+    unsigned reads;
+    bool cacheable;
+
+    ObjectInfo()
+      : bytes(0),
+        memBytes(0),
+        usecs(0),
+        reads(0),
+        cacheable(true)
+      { }
+
+    double readTime() const
+      { return reads > 0 ? static_cast<double>(usecs) / reads : 0; }
+  };
+
+  // a dirent or cluster of the zim file with the number in the upper bits
+  typedef zim::uint64_t Key;
+
+  Key makeKey(const zim::TraceRecord& r)
+    { return (static_cast<Key>(r.file) << 32) | r.idx; }
+
+  typedef std::map<Key, ObjectInfo> Infos;
+  typedef std::vector<Key> Accesses;
+
+  struct Trace
+  {
+    Accesses accesses;
+    zim::uint64_t hits;     // hits seen in the trace
+    zim::uint64_t uncached; // accesses of objects, which are never cached
+    Infos infos;
+    ObjectInfo average;
+
+    Trace()
+      : hits(0),
+        uncached(0)
+      { }
+
+    // drops the uncached objects and calculates the average
+    void finish()
+    {
+      Accesses a;
+      a.reserve(accesses.size());
+      for (Accesses::const_iterator it = accesses.begin(); it != accesses.end(); ++it)
+      {
+        if (infos[*it].cacheable)
+          a.push_back(*it);
+        else
+          ++uncached;
+      }
+      accesses.swap(a);
+
+      zim::uint64_t bytes = 0;
+      zim::uint64_t memBytes = 0;
+      unsigned count = 0;
+      for (Infos::const_iterator it = infos.begin(); it != infos.end(); ++it)
+      {
+        if (it->second.cacheable && it->second.reads > 0)
+        {
+          bytes += it->second.bytes;
+          memBytes += it->second.memBytes;
+          average.usecs += it->second.usecs;
+          average.reads += it->second.reads;
+          ++count;
+        }
+      }
+
+      if (count > 0)
+      {
+        average.bytes = static_cast<zim::size_type>(bytes / count);
+        average.memBytes = static_cast<zim::size_type>(memBytes / count);
+      }
+    }
+
+    const ObjectInfo& info(Key idx) const
+    {
+      Infos::const_iterator it = infos.find(idx);
+      return it == infos.end() || it->second.reads == 0 ? average : it->second;
+    }
+  };
+
+  struct Result
+  {
+    zim::uint64_t hits;
+    zim::uint64_t misses;
+    zim::uint64_t bytes;
+    double usecs;
+    zim::size_type overhead;
+  };
+
+  Result simulate(const Trace& trace, zim::CachePolicy policy, std::size_t maxElements, std::size_t maxCost)
+  {
+    zim::BasicCache<Key, char>* cache
+      = zim::createCache<Key, char, zim::CacheHash<Key> >(policy, maxElements, maxCost);
+
+    Result result = Result();
+    for (Accesses::const_iterator it = trace.accesses.begin(); it != trace.accesses.end(); ++it)
+    {
+      if (cache->getptr(*it))
+      {
+        ++result.hits;
+        continue;
+      }
+
+      const ObjectInfo& info = trace.info(*it);
+      ++result.misses;
+      result.bytes += info.bytes;
+      result.usecs += info.readTime();
+      cache->put(*it, 0, maxCost > 0 ? std::max(info.memBytes, zim::size_type(1)) : 1);
+    }
+
+    result.overhead = cache->getOverhead();
+    delete cache;
+    return result;
+  }
+
+  std::vector<std::size_t> parseSizes(const std::string& s)
+  {
+    std::vector<std::size_t> ret;
+    std::istringstream in(s);
+    std::string v;
+    while (std::getline(in, v, ','))
+    {
+      std::istringstream vs(v);
+      zim::uint64_t size = 0;
+      char unit = '\0';
+      vs >> size >> unit;
+
+      zim::uint64_t factor = 1;
+      switch (unit)
+      {
+        case 'k':
+        case 'K': factor = 1024; break;
+        case 'm':
+        case 'M': factor = 1024 * 1024; break;
+        case 'g':
+        case 'G': factor = 1024 * 1024 * 1024; break;
+      }
+
+      // a size, which does not fit, must not wrap to 0, which is unlimited
+      if (vs.bad() || size == 0 || size > std::numeric_limits<std::size_t>::max() / factor)
+        throw std::runtime_error("invalid size \"" + v + '"');
+
+      ret.push_back(static_cast<std::size_t>(size * factor));
+    }
+    return ret;
+  }
+
+  std::vector<zim::CachePolicy> parsePolicies(const std::string& s)
+  {
+    std::vector<zim::CachePolicy> ret;
+    std::istringstream in(s);
+    std::string v;
+    while (std::getline(in, v, ','))
+      ret.push_back(zim::getCachePolicy(v));
+    return ret;
+  }
+
+  void simulate(const std::string& title, const Trace& trace,
+                const std::vector<zim::CachePolicy>& policies,
+                const std::vector<std::size_t>& sizes, bool bySize)
+  {
+    unsigned lookups = trace.accesses.size() + trace.uncached;
+    std::cout << title << ": " << lookups << " lookups";
+    if (lookups == 0)
+    {
+      std::cout << std::endl;
+      return;
+    }
+
+    // every cached object misses at least once
+    unsigned distinct = 0;
+    for (Infos::const_iterator it = trace.infos.begin(); it != trace.infos.end(); ++it)
+      if (it->second.cacheable)
+        ++distinct;
+
+    std::cout << ", " << trace.uncached << " not cacheable, "
+              << distinct << " distinct, "
+              << std::fixed << std::setprecision(2)
+              << (trace.accesses.empty() ? 0.0 : 100.0 * trace.hits / trace.accesses.size()) << "% hits in trace, "
+              << (trace.accesses.empty() ? 0.0 : 100.0 - 100.0 * distinct / trace.accesses.size()) << "% hits at most\n"
+              << "policy        size        hit ratio  misses      read bytes    read time  overhead\n";
+
+    for (std::vector<zim::CachePolicy>::const_iterator p = policies.begin(); p != policies.end(); ++p)
+    {
+      for (std::vector<std::size_t>::const_iterator s = sizes.begin(); s != sizes.end(); ++s)
+      {
+        Result r = bySize ? simulate(trace, *p, std::numeric_limits<std::size_t>::max(), *s)
+                          : simulate(trace, *p, *s, 0);
+
+        std::ostringstream size;
+        if (bySize)
+          size << (*s / 1024) << 'k';
+        else
+          size << *s;
+
+        double total = r.hits + r.misses;
+        std::cout << std::left << std::setw(14) << zim::getCachePolicyName(*p)
+                  << std::setw(12) << size.str()
+                  << std::right << std::setw(9) << (total > 0 ? 100.0 * r.hits / total : 0) << "% "
+                  << std::setw(10) << r.misses << ' '
+                  << std::setw(14) << r.bytes << ' '
+                  << std::setw(10) << (r.usecs / 1e6) << "s "
+                  << std::setw(9) << r.overhead << '\n';
+      }
+    }
+
+    std::cout << std::endl;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    log_init();
+
+    zim::Arg<std::string> direntSizes(argc, argv, 'd', "64,128,256,512,1024,2048,4096,8192");
+    zim::Arg<std::string> clusterBytes(argc, argv, 'c', "4M,8M,16M,32M,64M,128M,256M");
+    zim::Arg<std::string> clusterCounts(argc, argv, 'n');
+    zim::Arg<std::string> policies(argc, argv, 'p', "winnerlooser,tinylfu,arc");
+
+    if (argc != 2)
+    {
+      std::cerr << "usage: " << argv[0] << " [options] tracefile\n"
+                   "\n"
+                   "Replays a trace recorded with ZIM_TRACE against caches of different\n"
+                   "sizes and policies.\n"
+                   "\n"
+                   "options:\n"
+                   "  -d sizes     dirent cache sizes (default 64,128,256,512,1024,2048,4096,8192)\n"
+                   "  -c sizes     cluster cache sizes in bytes with optional unit k, M or G\n"
+                   "               (default 4M,8M,16M,32M,64M,128M,256M)\n"
+                   "  -n sizes     cluster cache sizes in number of clusters instead of bytes\n"
+                   "  -p policies  cache policies (default winnerlooser,tinylfu,arc)\n"
+                   "\n"
+                   "The read bytes and read time are estimated from the misses in the trace.\n"
+                   "The accesses of all zim files in the trace are replayed against one cache.\n"
+                << std::flush;
+      return 1;
+    }
+
+    Trace dirents;
+    Trace clusters;
+
+    zim::TraceReader reader(argv[1]);
+    zim::TraceRecord r;
+    while (reader.next(r))
+    {
+      switch (r.kind)
+      {
+        case zim::traceDirent:
+          {
+            dirents.accesses.push_back(makeKey(r));
+            ObjectInfo& info = dirents.infos[makeKey(r)];
+            if (r.hit)
+              ++dirents.hits;
+            else
+            {
+              info.bytes = r.bytes;
+              info.usecs += r.usecs;
+              ++info.reads;
+            }
+          }
+          break;
+
+        case zim::traceCluster:
+          {
+            clusters.accesses.push_back(makeKey(r));
+            ObjectInfo& info = clusters.infos[makeKey(r)];
+            if (r.hit)
+            {
+              ++clusters.hits;
+              info.memBytes = std::max(info.memBytes, r.memBytes);
+            }
+          }
+          break;
+
+        case zim::traceClusterRead:
+          {
+            ObjectInfo& info = clusters.infos[makeKey(r)];
+            info.bytes = std::max(info.bytes, r.bytes);
+            info.memBytes = std::max(info.memBytes, r.memBytes);
+            info.usecs += r.usecs;
+            ++info.reads;
+            info.cacheable = r.compression == zim::zimcompZip
+                          || r.compression == zim::zimcompBzip2
+                          || r.compression == zim::zimcompLzma;
+          }
+          break;
+
+        case zim::traceOpen:
+          break;
+      }
+    }
+
+    // clusters neither read nor found in the cache are uncompressed
+    // clusters, of which just single blobs were read
+    for (Infos::iterator it = clusters.infos.begin(); it != clusters.infos.end(); ++it)
+      if (it->second.reads == 0 && it->second.memBytes == 0)
+        it->second.cacheable = false;
+
+    dirents.finish();
+    clusters.finish();
+
+    std::vector<zim::CachePolicy> p = parsePolicies(policies);
+
+    simulate("dirent cache", dirents, p, parseSizes(direntSizes), false);
+
+    if (clusterCounts.isSet())
+      simulate("cluster cache", clusters, p, parseSizes(clusterCounts), false);
+    else
+      simulate("cluster cache", clusters, p, parseSizes(clusterBytes), true);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+
+  return 0;
+}
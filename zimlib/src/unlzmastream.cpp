@@ -25,6 +25,7 @@
 #include <sstream>
 #include <cstring>
 #include "envvalue.h"
+#include "decoderpool.h"
 
 log_define("zim.lzma.uncompress")
 
@@ -61,22 +62,66 @@ namespace zim
 
   }
 
+  struct UnlzmaStreamBuf::Decoder
+  {
+    lzma_stream stream;
+    std::vector<char> buffer;
+
+    Decoder()
+      { std::memset(reinterpret_cast<void*>(&stream), 0, sizeof(stream)); }
+    ~Decoder()
+      { ::lzma_end(&stream); }
+  };
+
+  namespace
+  {
+    DecoderPool<UnlzmaStreamBuf::Decoder>& decoderPool()
+      { return DecoderPool<UnlzmaStreamBuf::Decoder>::getInstance(); }
+
+    UnlzmaStreamBuf::Decoder* getDecoder(unsigned bufsize)
+    {
+      UnlzmaStreamBuf::Decoder* decoder = decoderPool().get();
+      if (decoder == 0)
+        decoder = new UnlzmaStreamBuf::Decoder();
+      if (decoder->buffer.size() < bufsize)
+        decoder->buffer.resize(bufsize);
+      return decoder;
+    }
+
+    void initDecoder(lzma_stream& stream)
+    {
+      stream.next_in = 0;
+      stream.avail_in = 0;
+
+      // a decoder, which was used before, keeps its memory including the
+      // dictionary, when it is initialized again
+      unsigned memsize = envMemSize("ZIM_LZMA_MEMORY_SIZE", LZMA_MEMORY_SIZE * 1024 * 1024);
+      checkError(
+        ::lzma_stream_decoder(&stream, memsize, 0));
+    }
+  }
+
   UnlzmaStreamBuf::UnlzmaStreamBuf(std::streambuf* sinksource_, unsigned bufsize_)
-    : iobuffer(new char_type[bufsize_]),
+    : decoder(getDecoder(bufsize_)),
+      stream(decoder->stream),
+      iobuffer(&decoder->buffer[0]),
       bufsize(bufsize_),
       sinksource(sinksource_)
   {
-    std::memset(reinterpret_cast<void*>(&stream), 0, sizeof(stream));
-
-    unsigned memsize = envMemSize("ZIM_LZMA_MEMORY_SIZE", LZMA_MEMORY_SIZE * 1024 * 1024);
-    checkError(
-      ::lzma_stream_decoder(&stream, memsize, 0));
+    try
+    {
+      initDecoder(stream);
+    }
+    catch (...)
+    {
+      delete decoder;
+      throw;
+    }
   }
 
   UnlzmaStreamBuf::~UnlzmaStreamBuf()
   {
-    ::lzma_end(&stream);
-    delete[] iobuffer;
+    decoderPool().put(decoder);
   }
 
   UnlzmaStreamBuf::int_type UnlzmaStreamBuf::overflow(int_type c)
@@ -155,6 +200,45 @@ namespace zim
     return sgetc();
   }
 
+  void unlzmaBuffer(const char* data, std::size_t size, Buffer& out, std::size_t sizeHint)
+  {
+    UnlzmaStreamBuf::Decoder* decoder = getDecoder(0);
+    lzma_stream& stream = decoder->stream;
+
+    try
+    {
+      initDecoder(stream);
+
+      stream.next_in = reinterpret_cast<const uint8_t*>(data);
+      stream.avail_in = size;
+
+      out.resize(initialOutputSize(size, sizeHint));
+      std::size_t count = 0;
+      lzma_ret ret = LZMA_OK;
+      while (ret != LZMA_STREAM_END)
+      {
+        if (count == out.size())
+          out.resize(out.size() * 2);
+
+        stream.next_out = reinterpret_cast<uint8_t*>(&out[count]);
+        stream.avail_out = out.size() - count;
+
+        ret = checkError(::lzma_code(&stream, LZMA_FINISH));
+
+        count = out.size() - stream.avail_out;
+      }
+
+      out.resize(count);
+    }
+    catch (...)
+    {
+      decoderPool().put(decoder);
+      throw;
+    }
+
+    decoderPool().put(decoder);
+  }
+
   int UnlzmaStreamBuf::sync()
   {
     if (pptr() && overflow(traits_type::eof()) == traits_type::eof())
@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/urlindex.h>
+#include <zim/endian.h>
+#include <zim/atomic.h>
+#include "log.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+log_define("zim.urlindex")
+
+namespace zim
+{
+  namespace
+  {
+    const char magic[] = "ZIMURLIX";
+    const size_type version = 1;
+    const unsigned headerSize = 40;
+    const unsigned slotSize = 8;
+
+    // numbers the temporary files of the process
+    volatile unsigned tmpCount = 0;
+
+    void putUint32(char* p, uint32_t v)
+    {
+      toLittleEndian(v, p);
+    }
+
+    uint32_t getUint32(const char* p)
+    {
+      uint32_t v;
+      std::memcpy(&v, p, sizeof(v));
+      return fromLittleEndian(&v);
+    }
+  }
+
+  uint64_t UrlIndex::hash(char ns, const std::string& url)
+  {
+    // FNV-1a over "ns/url" and the finalizer of MurmurHash3; the result
+    // must not depend on the platform, since it is stored in files
+    uint64_t h = (static_cast<uint64_t>(0xcbf29ce4) << 32) | 0x84222325;
+    const uint64_t prime = (static_cast<uint64_t>(0x100) << 32) | 0x000001b3;
+
+    h ^= static_cast<unsigned char>(ns);
+    h *= prime;
+    h ^= static_cast<unsigned char>('/');
+    h *= prime;
+    for (std::string::const_iterator it = url.begin(); it != url.end(); ++it)
+    {
+      h ^= static_cast<unsigned char>(*it);
+      h *= prime;
+    }
+
+    h ^= h >> 33;
+    h *= (static_cast<uint64_t>(0xff51afd7) << 32) | 0xed558ccd;
+    h ^= h >> 33;
+    h *= (static_cast<uint64_t>(0xc4ceb9fe) << 32) | 0x1a85ec53;
+    h ^= h >> 33;
+    return h;
+  }
+
+  size_type UrlIndex::getIdx(size_type slot) const
+  {
+    return getUint32(table + slot * slotSize + 4);
+  }
+
+  uint32_t UrlIndex::getHash(size_type slot) const
+  {
+    return getUint32(table + slot * slotSize);
+  }
+
+  void UrlIndex::init(size_type count)
+  {
+    // keep the load factor at or below 0.5
+    slots = 16;
+    while (slots < count * 2)
+      slots *= 2;
+
+    delete file;
+    file = 0;
+
+    data.assign(static_cast<std::size_t>(slots) * slotSize, '\xff');
+    table = &data[0];
+  }
+
+  void UrlIndex::insert(uint64_t h, size_type idx)
+  {
+    size_type slot = static_cast<size_type>(h) & (slots - 1);
+    while (getIdx(slot) != npos)
+      slot = (slot + 1) & (slots - 1);
+
+    char* p = &data[0] + slot * slotSize;
+    putUint32(p, static_cast<uint32_t>(h >> 32));
+    putUint32(p + 4, idx);
+  }
+
+  size_type UrlIndex::lookup(uint64_t h, unsigned& probe) const
+  {
+    uint32_t hh = static_cast<uint32_t>(h >> 32);
+    while (probe < slots)
+    {
+      size_type slot = (static_cast<size_type>(h) + probe) & (slots - 1);
+      ++probe;
+
+      size_type idx = getIdx(slot);
+      if (idx == npos)
+        break;
+      if (getHash(slot) == hh)
+        return idx;
+    }
+
+    probe = slots;
+    return npos;
+  }
+
+  bool UrlIndex::read(const std::string& fname, const Uuid& uuid, size_type count)
+  {
+    {
+      std::ifstream in(fname.c_str());
+      if (!in)
+      {
+        log_debug("url index \"" << fname << "\" not found");
+        return false;
+      }
+    }
+
+    FileReader* f;
+    try
+    {
+      f = new FileReader(fname);
+    }
+    catch (const std::exception& e)
+    {
+      log_debug("url index \"" << fname << "\" not read: " << e.what());
+      return false;
+    }
+
+    try
+    {
+      char header[headerSize];
+      f->read(header, 0, headerSize);
+
+      size_type s = getUint32(header + 12);
+      if (std::memcmp(header, magic, 8) != 0
+        || getUint32(header + 8) != version
+        || getUint32(header + 16) != count
+        || std::memcmp(header + 24, uuid.data, 16) != 0
+        || s == 0 || (s & (s - 1)) != 0 || s < count
+        || f->fsize() != headerSize + static_cast<offset_type>(s) * slotSize)
+      {
+        log_warn("url index \"" << fname << "\" does not match the zim file; ignored");
+        delete f;
+        return false;
+      }
+
+      offset_type tableSize = static_cast<offset_type>(s) * slotSize;
+      std::vector<char> buffer;
+      const char* p = f->map() ? f->data(headerSize, tableSize) : 0;
+      if (!p)
+      {
+        buffer.resize(tableSize);
+        f->read(&buffer[0], headerSize, tableSize);
+        p = &buffer[0];
+      }
+
+      // a damaged index must not return articles, which do not exist
+      for (size_type slot = 0; slot < s; ++slot)
+      {
+        size_type idx = getUint32(p + slot * slotSize + 4);
+        if (idx != npos && idx >= count)
+        {
+          log_warn("url index \"" << fname << "\" is damaged; ignored");
+          delete f;
+          return false;
+        }
+      }
+
+      if (buffer.empty())
+      {
+        log_debug("url index \"" << fname << "\" mapped");
+        data.clear();
+        delete file;
+        file = f;
+        table = p;
+      }
+      else
+      {
+        log_debug("read url index \"" << fname << '"');
+        data.swap(buffer);
+        delete f;
+        delete file;
+        file = 0;
+        table = &data[0];
+      }
+
+      slots = s;
+      return true;
+    }
+    catch (const std::exception& e)
+    {
+      log_warn("failed to read url index \"" << fname << "\": " << e.what());
+      delete f;
+      return false;
+    }
+  }
+
+  void UrlIndex::write(const std::string& fname, const Uuid& uuid, size_type count) const
+  {
+    // the temporary file is unique, so that processes creating the same
+    // index at the same time do not write into the same file
+    std::ostringstream s;
+    s << fname << '.' << ::getpid() << '.' << atomicIncrement(tmpCount) << ".tmp";
+    std::string tmpname = s.str();
+
+    {
+      std::ofstream out(tmpname.c_str(), std::ios::out | std::ios::binary);
+      if (!out)
+        throw std::runtime_error("cannot create url index \"" + tmpname + '"');
+
+      char header[headerSize];
+      std::memset(header, 0, headerSize);
+      std::memcpy(header, magic, 8);
+      putUint32(header + 8, version);
+      putUint32(header + 12, slots);
+      putUint32(header + 16, count);
+      std::memcpy(header + 24, uuid.data, 16);
+
+      out.write(header, headerSize);
+      out.write(table, static_cast<std::streamsize>(slots) * slotSize);
+      out.close();
+
+      if (out.fail())
+      {
+        std::remove(tmpname.c_str());
+        throw std::runtime_error("failed to write url index \"" + tmpname + '"');
+      }
+    }
+
+    if (std::rename(tmpname.c_str(), fname.c_str()) != 0)
+    {
+      std::remove(tmpname.c_str());
+      throw std::runtime_error("failed to rename url index to \"" + fname + '"');
+    }
+
+    log_debug("url index \"" << fname << "\" written");
+  }
+
+}
@@ -54,6 +54,7 @@ namespace zim
   {
     ZimCreator::ZimCreator()
       : minChunkSize(1024-64),
+        withClusterInfo(false),
         nextMimeIdx(0),
 #ifdef ENABLE_LZMA
         compression(zimcompLzma),
@@ -69,7 +70,8 @@ namespace zim
     }
 
     ZimCreator::ZimCreator(int& argc, char* argv[])
-      : nextMimeIdx(0),
+      : withClusterInfo(false),
+        nextMimeIdx(0),
 #ifdef ENABLE_LZMA
         compression(zimcompLzma),
 #elif ENABLE_BZIP2
@@ -87,6 +89,8 @@ namespace zim
       else
         minChunkSize = Arg<unsigned>(argc, argv, 's', 1024-64);
 
+      withClusterInfo = Arg<bool>(argc, argv, "--cluster-info");
+
 #ifdef ENABLE_ZLIB
       if (Arg<bool>(argc, argv, "--zlib"))
         compression = zimcompZip;
@@ -137,7 +141,7 @@ namespace zim
       INFO("collect articles");
       std::ofstream out(tmpfname.c_str());
       currentSize =
-        80 /* for header */ +
+        headerSize() /* for header */ +
         1 /* for mime type table termination */ +
         16 /* for md5sum */;
 
@@ -243,6 +247,8 @@ namespace zim
                    dirent.getTitle() << '\"');
           offset_type start = out.tellp();
           clusterOffsets.push_back(start);
+          clusterInfo.push_back(cluster->size());
+          clusterInfo.push_back(cluster->count());
           out << *cluster;
           log_debug("cluster written");
           cluster->clear();
@@ -256,7 +262,8 @@ namespace zim
           }
           offset_type end = out.tellp();
           currentSize += (end - start) +
-            sizeof(offset_type) /* for cluster pointer entry */;
+            sizeof(offset_type) /* for cluster pointer entry */ +
+            (withClusterInfo ? 2 * sizeof(size_type) : 0) /* for cluster info entry */;
         }
       }
 
@@ -264,6 +271,8 @@ namespace zim
       if (compCluster.count() > 0)
       {
         clusterOffsets.push_back(out.tellp());
+        clusterInfo.push_back(compCluster.size());
+        clusterInfo.push_back(compCluster.count());
         out << compCluster;
         for (DirentPtrsType::iterator dpi = uncompDirents.begin();
              dpi != uncompDirents.end(); ++dpi)
@@ -278,6 +287,8 @@ namespace zim
       if (uncompCluster.count() > 0)
       {
         clusterOffsets.push_back(out.tellp());
+        clusterInfo.push_back(uncompCluster.size());
+        clusterInfo.push_back(uncompCluster.count());
         out << uncompCluster;
       }
       uncompCluster.clear();
@@ -422,6 +433,11 @@ namespace zim
       header.setTitleIdxPos( titleIdxPos() );
       header.setClusterCount( clusterOffsets.size() );
       header.setClusterPtrPos( clusterPtrPos() );
+      if (withClusterInfo)
+      {
+        header.setMinorVersion( Fileheader::clusterInfoMinorVersion );
+        header.setClusterInfoPos( clusterInfoPos() );
+      }
       header.setChecksumPos( checksumPos() );
 
       log_debug(
@@ -433,6 +449,7 @@ namespace zim
            " indexPos=" << indexPos() <<
            " clusterPtrSize=" << clusterPtrSize() <<
            " clusterPtrPos=" << clusterPtrPos() <<
+           " clusterInfoPos=" << clusterInfoPos() <<
            " clusterCount=" << clusterCount() <<
            " articleCount=" << articleCount() <<
            " articleCount=" << dirents.size() <<
@@ -524,7 +541,7 @@ namespace zim
 
       // write cluster offset list
 
-      off += clusterOffsets.size() * sizeof(offset_type);
+      off += clusterPtrSize() + clusterInfoSize();
       for (OffsetsType::const_iterator it = clusterOffsets.begin(); it != clusterOffsets.end(); ++it)
       {
         offset_type o = (off + *it);
@@ -534,6 +551,19 @@ namespace zim
 
       log_debug("after writing clusterOffsets - pos=" << out.tellp());
 
+      // write cluster info
+
+      if (withClusterInfo)
+      {
+        for (SizeVectorType::const_iterator it = clusterInfo.begin(); it != clusterInfo.end(); ++it)
+        {
+          size_type v = fromLittleEndian<size_type>(&*it);
+          out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+        }
+
+        log_debug("after writing clusterInfo - pos=" << out.tellp());
+      }
+
       // write cluster data
 
       if (!isEmpty)
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include <zim/accesstrace.h>
+#include <stdexcept>
+#include <fstream>
+#include <cstdio>
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+
+class AccessTraceTest : public cxxtools::unit::TestSuite
+{
+  public:
+    AccessTraceTest()
+      : cxxtools::unit::TestSuite("zim::AccessTraceTest")
+    {
+      registerMethod("ReadWrite", *this, &AccessTraceTest::ReadWrite);
+      registerMethod("InvalidFile", *this, &AccessTraceTest::InvalidFile);
+    }
+
+    void ReadWrite()
+    {
+      const char* fname = "accesstrace-test.trace";
+
+      zim::AccessTrace trace;
+      CXXTOOLS_UNIT_ASSERT(!trace.enabled());
+      trace.record(0, zim::traceDirent, 1, true);   // ignored
+
+      trace.open(fname);
+      CXXTOOLS_UNIT_ASSERT(trace.enabled());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(trace.getFilename(), fname);
+      zim::Uuid uuid("1234567890abcdef");
+      unsigned file = trace.addFile(uuid);
+      trace.record(file, zim::traceDirent, 17, false, 42, 0, 5);
+      trace.record(file, zim::traceClusterRead, 123456, false, 70000, 1048576, 1234, zim::zimcompLzma);
+      unsigned file2 = trace.addFile(uuid);
+      CXXTOOLS_UNIT_ASSERT(file2 != file);
+      trace.record(file2, zim::traceCluster, 123456, true, 0, 1048576);
+      trace.close();
+      CXXTOOLS_UNIT_ASSERT(!trace.enabled());
+
+      zim::TraceReader reader(fname);
+      zim::TraceRecord r;
+
+      CXXTOOLS_UNIT_ASSERT(reader.next(r));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.kind, zim::traceOpen);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.file, file);
+
+      CXXTOOLS_UNIT_ASSERT(reader.next(r));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.kind, zim::traceDirent);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.file, file);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.idx, 17);
+      CXXTOOLS_UNIT_ASSERT(!r.hit);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.bytes, 42);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.usecs, 5);
+
+      CXXTOOLS_UNIT_ASSERT(reader.next(r));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.kind, zim::traceClusterRead);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.idx, 123456);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.bytes, 70000);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.memBytes, 1048576);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.usecs, 1234);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.compression, zim::zimcompLzma);
+
+      zim::uint64_t time = r.time;
+      CXXTOOLS_UNIT_ASSERT(reader.next(r));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.kind, zim::traceOpen);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.file, file2);
+
+      CXXTOOLS_UNIT_ASSERT(reader.next(r));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.kind, zim::traceCluster);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.file, file2);
+      CXXTOOLS_UNIT_ASSERT(r.hit);
+      CXXTOOLS_UNIT_ASSERT(r.time >= time);
+
+      CXXTOOLS_UNIT_ASSERT(!reader.next(r));
+
+      std::remove(fname);
+    }
+
+    void InvalidFile()
+    {
+      const char* fname = "accesstrace-test.invalid";
+      {
+        std::ofstream out(fname);
+        out << "no trace";
+      }
+
+      CXXTOOLS_UNIT_ASSERT_THROW(zim::TraceReader reader(fname), std::runtime_error);
+      std::remove(fname);
+    }
+
+};
+
+cxxtools::unit::RegisterTest<AccessTraceTest> register_AccessTraceTest;
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include <zim/bufferpool.h>
+#include <cstring>
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+
+class BufferPoolTest : public cxxtools::unit::TestSuite
+{
+  public:
+    BufferPoolTest()
+      : cxxtools::unit::TestSuite("zim::BufferPoolTest")
+    {
+      registerMethod("SizeClass", *this, &BufferPoolTest::SizeClass);
+      registerMethod("Reuse", *this, &BufferPoolTest::Reuse);
+      registerMethod("Resize", *this, &BufferPoolTest::Resize);
+    }
+
+    void SizeClass()
+    {
+      zim::BufferPool& pool = zim::BufferPool::getInstance();
+
+      std::size_t s = 10;
+      char* p = pool.allocate(s);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(s, 4096);
+      pool.release(p, s);
+
+      s = 5000;
+      p = pool.allocate(s);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(s, 5120);
+      pool.release(p, s);
+
+      s = 1000000;
+      p = pool.allocate(s);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(s, 1048576);
+      pool.release(p, s);
+    }
+
+    void Reuse()
+    {
+      zim::BufferPool& pool = zim::BufferPool::getInstance();
+      pool.purge();
+
+      std::size_t s = 100000;
+      char* p = pool.allocate(s);
+      pool.release(p, s);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(pool.getPooledBytes(), s);
+
+      std::size_t s2 = 99000;
+      char* p2 = pool.allocate(s2);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(p2, p);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(s2, s);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(pool.getPooledBytes(), 0);
+      pool.release(p2, s2);
+
+      pool.purge();
+      CXXTOOLS_UNIT_ASSERT_EQUALS(pool.getPooledBytes(), 0);
+    }
+
+    void Resize()
+    {
+      zim::Buffer buffer;
+      CXXTOOLS_UNIT_ASSERT(buffer.empty());
+
+      buffer.assign("hello", "hello" + 5);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(buffer.size(), 5);
+
+      buffer.resize(100000);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(buffer.size(), 100000);
+      CXXTOOLS_UNIT_ASSERT(buffer.capacity() >= 100000);
+      CXXTOOLS_UNIT_ASSERT(std::memcmp(buffer.data(), "hello", 5) == 0);
+
+      buffer.resize(3);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(buffer.size(), 3);
+      CXXTOOLS_UNIT_ASSERT(buffer.capacity() >= 100000);
+
+      buffer.clear();
+      CXXTOOLS_UNIT_ASSERT(buffer.empty());
+      CXXTOOLS_UNIT_ASSERT(buffer.data() == 0);
+    }
+
+};
+
+cxxtools::unit::RegisterTest<BufferPoolTest> register_BufferPoolTest;
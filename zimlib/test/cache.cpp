@@ -0,0 +1,407 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/cache.h>
+#include <zim/concurrentcache.h>
+#include <zim/tinylfucache.h>
+#include <zim/arccache.h>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+
+class CacheTest : public cxxtools::unit::TestSuite
+{
+  public:
+    CacheTest()
+      : cxxtools::unit::TestSuite("zim::CacheTest")
+    {
+      registerMethod("testPutGet", *this, &CacheTest::testPutGet);
+      registerMethod("testDropLooser", *this, &CacheTest::testDropLooser);
+      registerMethod("testPutTop", *this, &CacheTest::testPutTop);
+      registerMethod("testErase", *this, &CacheTest::testErase);
+      registerMethod("testSetMaxElements", *this, &CacheTest::testSetMaxElements);
+      registerMethod("testStringKey", *this, &CacheTest::testStringKey);
+      registerMethod("testCost", *this, &CacheTest::testCost);
+      registerMethod("testConcurrentCache", *this, &CacheTest::testConcurrentCache);
+      registerMethod("testTinyLfu", *this, &CacheTest::testTinyLfu);
+      registerMethod("testArc", *this, &CacheTest::testArc);
+      registerMethod("testPolicy", *this, &CacheTest::testPolicy);
+      registerMethod("testUnlimitedCount", *this, &CacheTest::testUnlimitedCount);
+    }
+
+    void testPutGet()
+    {
+      zim::Cache<unsigned, unsigned> cache(4);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getMaxElements(), 4);
+
+      for (unsigned n = 1; n <= 4; ++n)
+        cache.put(n, n * 10);
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 4);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get(1), 10);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get(4), 40);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get(5, 17), 17);
+      CXXTOOLS_UNIT_ASSERT(!cache.getx(6).first);
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getHits(), 2);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getMisses(), 2);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.hitRatio(), 0.5);
+
+      cache.put(4, 41);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get(4), 41);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 4);
+    }
+
+    void testDropLooser()
+    {
+      zim::Cache<unsigned, unsigned> cache(4);
+
+      // 1 and 2 are winners, 3 and 4 loosers
+      for (unsigned n = 1; n <= 4; ++n)
+        cache.put(n, n);
+
+      // the oldest looser is dropped
+      cache.put(5, 5);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 4);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getEvictions(), 1);
+      CXXTOOLS_UNIT_ASSERT(!cache.getx(3).first);
+
+      // 4 becomes a winner, so 1 becomes the newest looser and 5 is dropped next
+      CXXTOOLS_UNIT_ASSERT(cache.getx(4).first);
+      cache.put(6, 6);
+      CXXTOOLS_UNIT_ASSERT(!cache.getx(5).first);
+      CXXTOOLS_UNIT_ASSERT(cache.getx(2).first);
+      CXXTOOLS_UNIT_ASSERT(cache.getx(4).first);
+      CXXTOOLS_UNIT_ASSERT(cache.getx(6).first);
+
+      // a lot of new elements do not push out the winners
+      for (unsigned n = 100; n < 200; ++n)
+        cache.put(n, n);
+      CXXTOOLS_UNIT_ASSERT(cache.getx(4).first);
+      CXXTOOLS_UNIT_ASSERT(cache.getx(6).first);
+      CXXTOOLS_UNIT_ASSERT(cache.getx(199).first);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 4);
+    }
+
+    void testPutTop()
+    {
+      zim::Cache<unsigned, unsigned> cache(4);
+
+      for (unsigned n = 1; n <= 4; ++n)
+        cache.put(n, n);
+
+      cache.put_top(5, 5);
+      for (unsigned n = 100; n < 110; ++n)
+        cache.put(n, n);
+
+      CXXTOOLS_UNIT_ASSERT(cache.getx(5).first);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 4);
+    }
+
+    void testErase()
+    {
+      zim::Cache<unsigned, unsigned> cache(4);
+
+      for (unsigned n = 1; n <= 4; ++n)
+        cache.put(n, n);
+
+      CXXTOOLS_UNIT_ASSERT(cache.erase(1));
+      CXXTOOLS_UNIT_ASSERT(!cache.erase(1));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 3);
+      CXXTOOLS_UNIT_ASSERT(!cache.getx(1).first);
+
+      cache.clear(true);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getHits(), 0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getMisses(), 0);
+    }
+
+    void testSetMaxElements()
+    {
+      zim::Cache<unsigned, unsigned> cache(100);
+
+      for (unsigned n = 0; n < 100; ++n)
+        cache.put(n, n);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 100);
+
+      cache.setMaxElements(10);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 10);
+
+      // the newest winners are kept
+      for (unsigned n = 45; n < 50; ++n)
+        CXXTOOLS_UNIT_ASSERT(cache.getx(n).first);
+
+      cache.setMaxElements(1000);
+      for (unsigned n = 1000; n < 3000; ++n)
+        cache.put(n, n);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 1000);
+      CXXTOOLS_UNIT_ASSERT(cache.getx(2999).first);
+    }
+
+    void testStringKey()
+    {
+      zim::Cache<std::string, int> cache(4);
+      cache.put("foo", 1);
+      cache.put("bar", 2);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get("foo"), 1);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get("bar"), 2);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get("baz", 3), 3);
+    }
+
+    void testCost()
+    {
+      zim::Cache<unsigned, unsigned> cache(1000, 100);
+
+      cache.put(1, 1, 30);
+      cache.put(2, 2, 30);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getCost(), 60);
+
+      // 3 does not fit, so the oldest looser is dropped
+      cache.put(3, 3, 50);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 2);
+      CXXTOOLS_UNIT_ASSERT(cache.getCost() <= 100);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getPeakCost(), 110);
+      CXXTOOLS_UNIT_ASSERT(!cache.getx(2).first);
+      CXXTOOLS_UNIT_ASSERT(cache.getx(3).first);
+
+      // 1 becomes the winner again and 3, which does not fit besides, a looser
+      CXXTOOLS_UNIT_ASSERT(cache.getx(1).first);
+
+      // elements larger than the maximum cost are not cached
+      cache.put(4, 4, 101);
+      CXXTOOLS_UNIT_ASSERT(!cache.getx(4).first);
+
+      // many small elements do not push out the winners
+      for (unsigned n = 100; n < 200; ++n)
+        cache.put(n, n, 5);
+      CXXTOOLS_UNIT_ASSERT(cache.getx(1).first);
+      CXXTOOLS_UNIT_ASSERT(cache.getCost() <= 100);
+
+      cache.setMaxCost(20);
+      CXXTOOLS_UNIT_ASSERT(cache.getCost() <= 20);
+
+      cache.clear(true);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getCost(), 0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getPeakCost(), 0);
+
+      zim::ConcurrentCache<unsigned, unsigned> ccache(1000, 1000, 4);
+      for (unsigned n = 0; n < 1000; ++n)
+        ccache.put(n, n, 10);
+      CXXTOOLS_UNIT_ASSERT(ccache.getCost() <= 1000);
+      CXXTOOLS_UNIT_ASSERT(ccache.getPeakCost() >= ccache.getCost());
+      CXXTOOLS_UNIT_ASSERT(ccache.getPeakCost() <= 1000 + 4 * 10);
+    }
+
+    void testConcurrentCache()
+    {
+      zim::ConcurrentCache<unsigned, unsigned> small(16);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(small.getShardCount(), 1);
+
+      zim::ConcurrentCache<unsigned, unsigned> cache(4096);
+      CXXTOOLS_UNIT_ASSERT(cache.getShardCount() > 1);
+
+      for (unsigned n = 0; n < 1000; ++n)
+        cache.put(n, n + 1);
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 1000);
+      for (unsigned n = 0; n < 1000; ++n)
+        CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get(n), n + 1);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getHits(), 1000);
+
+      for (unsigned n = 1000; n < 100000; ++n)
+        cache.put(n, n);
+      CXXTOOLS_UNIT_ASSERT(cache.size() <= cache.getMaxElements() + cache.getShardCount());
+
+      cache.setMaxElements(64);
+      CXXTOOLS_UNIT_ASSERT(cache.size() <= 64 + cache.getShardCount());
+    }
+
+    // accesses the elements 1 to 50 repeatedly, then scans 1000 other
+    // elements once and returns the number of the first, which survived
+    template <typename CacheType>
+    unsigned scan(CacheType& cache)
+    {
+      for (unsigned r = 0; r < 4; ++r)
+        for (unsigned n = 1; n <= 50; ++n)
+          if (!cache.getx(n).first)
+            cache.put(n, n);
+
+      for (unsigned n = 1000; n < 2000; ++n)
+        if (!cache.getx(n).first)
+          cache.put(n, n);
+
+      unsigned ret = 0;
+      for (unsigned n = 1; n <= 50; ++n)
+        if (cache.contains(n))
+          ++ret;
+      return ret;
+    }
+
+    template <typename CacheType>
+    void checkCost(CacheType& cache)
+    {
+      for (unsigned n = 0; n < 100; ++n)
+      {
+        cache.put(n, n, 5 + n % 20);
+        cache.get(n % 10);
+        CXXTOOLS_UNIT_ASSERT(cache.getCost() <= 100);
+      }
+      CXXTOOLS_UNIT_ASSERT(cache.getPeakCost() >= 100 - 24);
+      CXXTOOLS_UNIT_ASSERT(cache.getPeakCost() <= 100 + 24);
+
+      // elements larger than the maximum cost are not cached
+      cache.put(200, 200, 101);
+      CXXTOOLS_UNIT_ASSERT(!cache.contains(200));
+
+      cache.setMaxCost(20);
+      CXXTOOLS_UNIT_ASSERT(cache.getCost() <= 20);
+
+      cache.clear(true);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getPeakCost(), 0);
+    }
+
+    void testTinyLfu()
+    {
+      zim::TinyLfuCache<unsigned, unsigned> cache(100);
+
+      cache.put(1, 10);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get(1), 10);
+      CXXTOOLS_UNIT_ASSERT(!cache.getx(2).first);
+      CXXTOOLS_UNIT_ASSERT(cache.erase(1));
+      CXXTOOLS_UNIT_ASSERT(!cache.contains(1));
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(scan(cache), 50);
+      CXXTOOLS_UNIT_ASSERT(cache.size() <= 100);
+      CXXTOOLS_UNIT_ASSERT(cache.getOverhead() > 0);
+
+      cache.setMaxElements(10);
+      CXXTOOLS_UNIT_ASSERT(cache.size() <= 10);
+
+      zim::TinyLfuCache<unsigned, unsigned> ccache(1000, 100);
+      checkCost(ccache);
+
+      // the frequencies survive, while a cache limited by cost fills up
+      zim::TinyLfuCache<unsigned, unsigned> bcache(std::numeric_limits<unsigned>::max(), 3000);
+      for (unsigned r = 0; r < 4; ++r)
+        for (unsigned n = 0; n < 1500; ++n)
+          if (!bcache.getx(n).first)
+            bcache.put(n, n, 1);
+      for (unsigned n = 10000; n < 20000; ++n)
+        if (!bcache.getx(n).first)
+          bcache.put(n, n, 1);
+      unsigned survived = 0;
+      for (unsigned n = 0; n < 1500; ++n)
+        if (bcache.contains(n))
+          ++survived;
+      CXXTOOLS_UNIT_ASSERT(survived >= 1490);
+    }
+
+    void testArc()
+    {
+      zim::ArcCache<unsigned, unsigned> cache(100);
+
+      cache.put(1, 10);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get(1), 10);
+      CXXTOOLS_UNIT_ASSERT(!cache.getx(2).first);
+      CXXTOOLS_UNIT_ASSERT(cache.erase(1));
+      CXXTOOLS_UNIT_ASSERT(!cache.contains(1));
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(scan(cache), 50);
+      CXXTOOLS_UNIT_ASSERT(cache.size() <= 100);
+
+      // a put of a dropped element found in the ghost list is no hit
+      zim::uint64_t hits = cache.getHits();
+      CXXTOOLS_UNIT_ASSERT(!cache.getx(1000).first);
+      cache.put(1000, 1000);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getHits(), hits);
+      CXXTOOLS_UNIT_ASSERT(cache.contains(1000));
+
+      cache.setMaxElements(10);
+      CXXTOOLS_UNIT_ASSERT(cache.size() <= 10);
+
+      zim::ArcCache<unsigned, unsigned> ccache(1000, 100);
+      checkCost(ccache);
+    }
+
+    void testPolicy()
+    {
+      CXXTOOLS_UNIT_ASSERT_EQUALS(zim::getCachePolicy("tinylfu"), zim::cachePolicyTinyLfu);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(zim::getCachePolicy("arc"), zim::cachePolicyArc);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(zim::getCachePolicy(zim::getCachePolicyName(zim::cachePolicyWinnerLooser)),
+                                  zim::cachePolicyWinnerLooser);
+      CXXTOOLS_UNIT_ASSERT_THROW(zim::getCachePolicy("lru"), std::runtime_error);
+
+      zim::CachePolicy policies[] = { zim::cachePolicyWinnerLooser, zim::cachePolicyTinyLfu, zim::cachePolicyArc };
+      for (unsigned p = 0; p < 3; ++p)
+      {
+        zim::ConcurrentCache<unsigned, unsigned> cache(1024, 0, 4, policies[p]);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getPolicy(), policies[p]);
+
+        for (unsigned n = 0; n < 10000; ++n)
+          cache.put(n, n);
+        CXXTOOLS_UNIT_ASSERT(cache.size() <= 1024 + cache.getShardCount());
+        CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size() + cache.getEvictions(), 10000);
+        CXXTOOLS_UNIT_ASSERT(cache.getOverhead() > 0);
+
+        unsigned found = 0;
+        for (unsigned n = 0; n < 10000; ++n)
+          if (cache.get(n) == n)
+            ++found;
+        CXXTOOLS_UNIT_ASSERT(found > 0);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getHits() + cache.getMisses(), 10000);
+      }
+    }
+
+    void testUnlimitedCount()
+    {
+      // caches limited by cost only pass the largest count
+      std::size_t unlimited = std::numeric_limits<std::size_t>::max();
+
+      zim::Cache<unsigned, unsigned> cache(unlimited, 100);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getMaxElements(), unlimited - 1);
+      cache.setMaxElements(unlimited);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getMaxElements(), unlimited - 1);
+
+      zim::CachePolicy policies[] = { zim::cachePolicyWinnerLooser, zim::cachePolicyTinyLfu, zim::cachePolicyArc };
+      for (unsigned p = 0; p < 3; ++p)
+      {
+        zim::BasicCache<unsigned, unsigned>* c =
+          zim::createCache<unsigned, unsigned, zim::CacheHash<unsigned> >(policies[p], unlimited, 100);
+        for (unsigned n = 0; n < 10; ++n)
+          c->put(n, n, 5);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(c->size(), 10);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(c->getCost(), 50);
+        delete c;
+      }
+
+      // each shard gets its part of the largest count
+      zim::ConcurrentCache<unsigned, unsigned> ccache(unlimited, 1000, 4);
+      for (unsigned n = 0; n < 10; ++n)
+        ccache.put(n, n, 5);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(ccache.size(), 10);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(ccache.getCost(), 50);
+    }
+
+};
+
+cxxtools::unit::RegisterTest<CacheTest> register_CacheTest;
@@ -21,14 +21,70 @@
 #include <zim/zim.h>
 #include <sstream>
 #include <algorithm>
+#include <vector>
+#include <cstring>
 
 #include <cxxtools/unit/testsuite.h>
 #include <cxxtools/unit/registertest.h>
 
 #include "config.h"
 
+#ifdef ENABLE_ZLIB
+#include <zlib.h>
+#endif
+
 class ClusterTest : public cxxtools::unit::TestSuite
 {
+    // returns true, when the cluster is read from the buffer
+    static bool readBuffer(zim::Cluster& cluster, const std::string& data, zim::size_type sizeHint)
+    {
+      try
+      {
+        return cluster.readBuffer(data.data(), data.size(), sizeHint);
+      }
+      catch (const std::exception&)
+      {
+        return false;
+      }
+    }
+
+    // Reads a compressed cluster with readBuffer with an exact size hint,
+    // without a hint, so that the output buffer must grow, and truncated.
+    void checkReadBuffer(zim::CompressionType compression)
+    {
+      zim::Cluster cluster;
+
+      std::string blob0;
+      for (unsigned n = 0; n < 20000; ++n)
+        blob0 += "0123456789";
+      std::string blob1("ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+
+      cluster.addBlob(blob0.data(), blob0.size());
+      cluster.addBlob(blob1.data(), blob1.size());
+      cluster.setCompression(compression);
+
+      std::ostringstream s;
+      s << cluster;
+      std::string data = s.str();
+      CXXTOOLS_UNIT_ASSERT(data.size() * 4 < cluster.size());
+
+      zim::size_type hints[] = { cluster.size(), 0 };
+      for (unsigned n = 0; n < 2; ++n)
+      {
+        zim::Cluster cluster2;
+        CXXTOOLS_UNIT_ASSERT(readBuffer(cluster2, data, hints[n]));
+        CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.getCompression(), compression);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.count(), 2);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.size(), cluster.size());
+        CXXTOOLS_UNIT_ASSERT(std::string(cluster2.getBlobPtr(0), cluster2.getBlobSize(0)) == blob0);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(cluster2.getBlobPtr(1), cluster2.getBlobSize(1)), blob1);
+      }
+
+      zim::Cluster cluster3;
+      CXXTOOLS_UNIT_ASSERT(!readBuffer(cluster3, data.substr(0, data.size() / 2), cluster.size()));
+      CXXTOOLS_UNIT_ASSERT(!readBuffer(cluster3, data.substr(0, data.size() / 2), 0));
+    }
+
   public:
     ClusterTest()
       : cxxtools::unit::TestSuite("zim::ClusterTest")
@@ -36,14 +92,20 @@ class ClusterTest : public cxxtools::unit::TestSuite
       registerMethod("CreateCluster", *this, &ClusterTest::CreateCluster);
       registerMethod("ReadWriteCluster", *this, &ClusterTest::ReadWriteCluster);
       registerMethod("ReadWriteEmpty", *this, &ClusterTest::ReadWriteEmpty);
+      registerMethod("ReadMapped", *this, &ClusterTest::ReadMapped);
 #ifdef ENABLE_ZLIB
       registerMethod("ReadWriteClusterZ", *this, &ClusterTest::ReadWriteClusterZ);
+      registerMethod("ReadBufferZ", *this, &ClusterTest::ReadBufferZ);
+      registerMethod("ZlibStreamEnd", *this, &ClusterTest::ZlibStreamEnd);
+      registerMethod("ReadBufferZFlushed", *this, &ClusterTest::ReadBufferZFlushed);
 #endif
 #ifdef ENABLE_BZIP2
       registerMethod("ReadWriteClusterBz2", *this, &ClusterTest::ReadWriteClusterBz2);
+      registerMethod("ReadBufferBz2", *this, &ClusterTest::ReadBufferBz2);
 #endif
 #ifdef ENABLE_LZMA
       registerMethod("ReadWriteClusterLzma", *this, &ClusterTest::ReadWriteClusterLzma);
+      registerMethod("ReadBufferLzma", *this, &ClusterTest::ReadBufferLzma);
 #endif
     }
 
@@ -113,6 +175,41 @@ class ClusterTest : public cxxtools::unit::TestSuite
       CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.getBlobSize(2), 0);
     }
 
+    void ReadMapped()
+    {
+      zim::Cluster cluster;
+
+      std::string blob0("123456789012345678901234567890");
+      std::string blob1("ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+      std::string blob2("abcdefghijklmnopqrstuvwxyz");
+
+      cluster.addBlob(blob0.data(), blob0.size());
+      cluster.addBlob(blob1.data(), blob1.size());
+      cluster.addBlob(blob2.data(), blob2.size());
+      cluster.setCompression(zim::zimcompNone);
+
+      std::ostringstream s;
+      s << cluster;
+      std::string data = s.str();
+
+      // the offsets follow the compression byte, so they are not aligned
+      zim::Cluster cluster2;
+      CXXTOOLS_UNIT_ASSERT(cluster2.readMapped(data.data() + 1, data.size() - 1, 0));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.count(), 3);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(cluster2.getBlobPtr(0), cluster2.getBlobSize(0)), blob0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(cluster2.getBlobPtr(2), cluster2.getBlobSize(2)), blob2);
+
+      // offsets, which decrease, are rejected
+      std::string damaged = data;
+      std::swap_ranges(damaged.begin() + 5, damaged.begin() + 9, damaged.begin() + 9);
+      zim::Cluster cluster3;
+      CXXTOOLS_UNIT_ASSERT(!cluster3.readMapped(damaged.data() + 1, damaged.size() - 1, 0));
+
+      // offsets past the end are rejected
+      zim::Cluster cluster4;
+      CXXTOOLS_UNIT_ASSERT(!cluster4.readMapped(data.data() + 1, data.size() - 2, 0));
+    }
+
 #ifdef ENABLE_ZLIB
     void ReadWriteClusterZ()
     {
@@ -144,6 +241,78 @@ class ClusterTest : public cxxtools::unit::TestSuite
       CXXTOOLS_UNIT_ASSERT(std::equal(cluster2.getBlobPtr(2), cluster2.getBlobPtr(2) + cluster2.getBlobSize(2), blob2.data()));
     }
 
+    void ReadBufferZ()
+    {
+      checkReadBuffer(zim::zimcompZip);
+    }
+
+    // the writer finishes the deflate stream
+    void ZlibStreamEnd()
+    {
+      zim::Cluster cluster;
+      std::string blob0("123456789012345678901234567890");
+      cluster.addBlob(blob0.data(), blob0.size());
+      cluster.setCompression(zim::zimcompZip);
+
+      std::ostringstream s;
+      s << cluster;
+      std::string data = s.str();
+
+      std::vector<char> out(cluster.size() + 1);
+      z_stream stream;
+      std::memset(&stream, 0, sizeof(stream));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(::inflateInit(&stream), Z_OK);
+      stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data() + 1));
+      stream.avail_in = data.size() - 1;
+      stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+      stream.avail_out = out.size();
+      int ret = ::inflate(&stream, Z_NO_FLUSH);
+      ::inflateEnd(&stream);
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(ret, Z_STREAM_END);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(out.size() - stream.avail_out, cluster.size());
+    }
+
+    // Clusters of older writers were just flushed and not finished. The
+    // cluster of 64k fills the initial output buffer of readBuffer without
+    // a size hint exactly.
+    void ReadBufferZFlushed()
+    {
+      zim::Cluster cluster;
+      std::string blob0(65536 - 3 * sizeof(zim::size_type) - 10, 'a');
+      std::string blob1("0123456789");
+      cluster.addBlob(blob0.data(), blob0.size());
+      cluster.addBlob(blob1.data(), blob1.size());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cluster.size(), 65536);
+
+      std::ostringstream s;
+      s << cluster;
+      std::string raw = s.str().substr(1);
+
+      std::vector<char> out(raw.size() + 1024);
+      z_stream stream;
+      std::memset(&stream, 0, sizeof(stream));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(::deflateInit(&stream, Z_DEFAULT_COMPRESSION), Z_OK);
+      stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(raw.data()));
+      stream.avail_in = raw.size();
+      stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+      stream.avail_out = out.size();
+      CXXTOOLS_UNIT_ASSERT_EQUALS(::deflate(&stream, Z_SYNC_FLUSH), Z_OK);
+      std::string data = static_cast<char>(zim::zimcompZip)
+        + std::string(&out[0], out.size() - stream.avail_out);
+      ::deflateEnd(&stream);
+
+      zim::size_type hints[] = { 0, cluster.size() };
+      for (unsigned n = 0; n < 2; ++n)
+      {
+        zim::Cluster cluster2;
+        CXXTOOLS_UNIT_ASSERT(cluster2.readBuffer(data.data(), data.size(), hints[n]));
+        CXXTOOLS_UNIT_ASSERT_EQUALS(cluster2.count(), 2);
+        CXXTOOLS_UNIT_ASSERT(std::string(cluster2.getBlobPtr(0), cluster2.getBlobSize(0)) == blob0);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(cluster2.getBlobPtr(1), cluster2.getBlobSize(1)), blob1);
+      }
+    }
+
 #endif
 
 #ifdef ENABLE_BZIP2
@@ -177,6 +346,11 @@ class ClusterTest : public cxxtools::unit::TestSuite
       CXXTOOLS_UNIT_ASSERT(std::equal(cluster2.getBlobPtr(2), cluster2.getBlobPtr(2) + cluster2.getBlobSize(2), blob2.data()));
     }
 
+    void ReadBufferBz2()
+    {
+      checkReadBuffer(zim::zimcompBzip2);
+    }
+
 #endif
 
 #ifdef ENABLE_LZMA
@@ -210,6 +384,11 @@ class ClusterTest : public cxxtools::unit::TestSuite
       CXXTOOLS_UNIT_ASSERT(std::equal(cluster2.getBlobPtr(2), cluster2.getBlobPtr(2) + cluster2.getBlobSize(2), blob2.data()));
     }
 
+    void ReadBufferLzma()
+    {
+      checkReadBuffer(zim::zimcompLzma);
+    }
+
 #endif
 
 };
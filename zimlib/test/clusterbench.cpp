@@ -0,0 +1,362 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+/*
+   Benchmark of the cluster size and compression used by zimwriter.
+
+   Reads a sample corpus from files or the article data of a zim file,
+   packs it into clusters of several sizes with each compression and
+   reports the compression ratio, the compression speed, the time to
+   decompress a full cluster and the time to fetch a random blob. The
+   clusters are written and read with ClusterImpl just like zimwriter and
+   FileImpl do.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+
+#include <zim/cluster.h>
+#include <zim/smartptr.h>
+#include <zim/file.h>
+#include <zim/fileiterator.h>
+#include <zim/article.h>
+#include <zim/fileobserver.h>
+#include <zim/latencyhistogram.h>
+
+#include "arg.h"
+#include "config.h"
+#include "random.h"
+
+namespace
+{
+  typedef std::vector<std::string> Corpus;
+
+  struct Codec
+  {
+    const char* name;
+    zim::CompressionType compression;
+  };
+
+  const Codec codecs[] = {
+    { "none", zim::zimcompNone },
+#ifdef ENABLE_ZLIB
+    { "zlib", zim::zimcompZip },
+#endif
+#ifdef ENABLE_BZIP2
+    { "bzip2", zim::zimcompBzip2 },
+#endif
+#ifdef ENABLE_LZMA
+    { "lzma", zim::zimcompLzma },
+#endif
+  };
+
+  const unsigned codecCount = sizeof(codecs) / sizeof(codecs[0]);
+
+  class CorpusReader
+  {
+      Corpus& corpus;
+      zim::uint64_t maxBytes;
+      zim::uint64_t bytes;
+
+    public:
+      CorpusReader(Corpus& corpus_, zim::uint64_t maxBytes_)
+        : corpus(corpus_),
+          maxBytes(maxBytes_),
+          bytes(0)
+        { }
+
+      bool full() const   { return bytes >= maxBytes; }
+
+      void add(const std::string& data)
+      {
+        if (data.empty() || full())
+          return;
+        corpus.push_back(data);
+        bytes += data.size();
+      }
+
+      // adds a file or the files of a directory recursively in name order
+      void addPath(const std::string& path)
+      {
+        struct stat st;
+        if (::stat(path.c_str(), &st) != 0)
+          throw std::runtime_error("cannot stat " + path);
+
+        if (S_ISDIR(st.st_mode))
+        {
+          DIR* dir = ::opendir(path.c_str());
+          if (dir == 0)
+            throw std::runtime_error("cannot open directory " + path);
+
+          std::vector<std::string> names;
+          struct dirent* e;
+          while ((e = ::readdir(dir)) != 0)
+            if (std::strcmp(e->d_name, ".") != 0 && std::strcmp(e->d_name, "..") != 0)
+              names.push_back(e->d_name);
+          ::closedir(dir);
+
+          std::sort(names.begin(), names.end());
+          for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end() && !full(); ++it)
+            addPath(path + '/' + *it);
+        }
+        else if (S_ISREG(st.st_mode))
+        {
+          std::ifstream in(path.c_str(), std::ios::binary);
+          std::ostringstream data;
+          data << in.rdbuf();
+          add(data.str());
+        }
+      }
+
+      // adds the data of the articles of a zim file in url order
+      void addZimFile(const std::string& filename)
+      {
+        zim::File file(filename);
+        for (zim::File::const_iterator it = file.begin(); it != file.end() && !full(); ++it)
+        {
+          if (it->isRedirect() || it->isLinktarget() || it->isDeleted())
+            continue;
+          zim::Blob b = it->getData();
+          add(std::string(b.data(), b.size()));
+        }
+      }
+
+      zim::uint64_t getBytes() const   { return bytes; }
+  };
+
+  struct Result
+  {
+    unsigned clusters;
+    zim::uint64_t rawBytes;
+    zim::uint64_t compressedBytes;
+    zim::uint64_t compressNsecs;
+    zim::LatencyHistogram decompress;
+    zim::LatencyHistogram fetch;
+
+    Result()
+      : clusters(0),
+        rawBytes(0),
+        compressedBytes(0),
+        compressNsecs(0)
+      { }
+  };
+
+  struct PackedCluster
+  {
+    std::string data;   // as written to the zim file
+    zim::size_type size;
+    zim::size_type count;
+  };
+
+  void writeCluster(zim::ClusterImpl& cluster, std::vector<PackedCluster>& clusters, Result& result)
+  {
+    std::ostringstream out;
+    zim::uint64_t start = zim::FileObserver::now();
+    out << cluster;
+    result.compressNsecs += zim::FileObserver::now() - start;
+
+    PackedCluster c;
+    c.data = out.str();
+    c.size = cluster.getSize();
+    c.count = cluster.getCount();
+    clusters.push_back(c);
+
+    result.rawBytes += c.size;
+    result.compressedBytes += c.data.size();
+    ++result.clusters;
+    cluster.clear();
+  }
+
+  // reads the blob like FileImpl: uncompressed clusters are used in place,
+  // compressed clusters are decompressed completely
+  zim::size_type fetchBlob(const PackedCluster& c, zim::size_type n)
+  {
+    zim::SmartPtr<zim::ClusterImpl> cluster = new zim::ClusterImpl();
+    bool ok = static_cast<zim::CompressionType>(c.data[0]) == zim::zimcompNone
+            ? cluster->readMapped(c.data.data() + 1, c.data.size() - 1, 0)
+            : cluster->readBuffer(c.data.data(), c.data.size(), c.size);
+    if (!ok)
+      throw std::runtime_error("error reading cluster");
+    return cluster->getBlob(n).size();
+  }
+
+  void benchmark(const Corpus& corpus, unsigned minChunkSize, const Codec& codec,
+                 unsigned fetches, Result& result)
+  {
+    std::vector<PackedCluster> clusters;
+
+    // pack the blobs like zimwriter: a cluster is closed, when it reaches
+    // the minimum size
+    zim::ClusterImpl cluster;
+    cluster.setCompression(codec.compression);
+    for (Corpus::const_iterator it = corpus.begin(); it != corpus.end(); ++it)
+    {
+      cluster.addBlob(it->data(), it->size());
+      if (cluster.getSize() >= minChunkSize * 1024)
+        writeCluster(cluster, clusters, result);
+    }
+    if (cluster.getCount() > 0)
+      writeCluster(cluster, clusters, result);
+
+    zim::size_type check = 0;
+    for (std::vector<PackedCluster>::const_iterator it = clusters.begin(); it != clusters.end(); ++it)
+    {
+      zim::uint64_t start = zim::FileObserver::now();
+      zim::ClusterImpl c;
+      if (!c.readBuffer(it->data.data(), it->data.size(), it->size))
+        throw std::runtime_error("error decompressing cluster");
+      result.decompress.record(zim::FileObserver::now() - start);
+      check += c.getCount();
+    }
+
+    if (check != corpus.size())
+      throw std::runtime_error("blobs lost in clusters");
+
+    // deterministic, so that all combinations fetch the same blobs
+    zim::Random random(1);
+    for (unsigned n = 0; n < fetches; ++n)
+    {
+      const PackedCluster& c = clusters[random.below(clusters.size())];
+      zim::size_type b = random.below(c.count);
+      zim::uint64_t start = zim::FileObserver::now();
+      fetchBlob(c, b);
+      result.fetch.record(zim::FileObserver::now() - start);
+    }
+  }
+
+  template <typename T>
+  std::vector<T> parseList(const std::string& s)
+  {
+    std::vector<T> ret;
+    std::istringstream in(s);
+    std::string item;
+    while (std::getline(in, item, ','))
+    {
+      std::istringstream v(item);
+      T t;
+      if (!(v >> t))
+        throw std::runtime_error("invalid list \"" + s + '"');
+      ret.push_back(t);
+    }
+    return ret;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    zim::Arg<std::string> sizeList(argc, argv, 's', "64,256,1024,4096");
+    zim::Arg<std::string> codecList(argc, argv, 'c');
+    zim::Arg<unsigned> fetches(argc, argv, 'n', 1000);
+    zim::Arg<unsigned> maxMBytes(argc, argv, 'm', 256);
+    zim::Arg<std::string> zimFile(argc, argv, 'z');
+
+    if (argc < 2 && !zimFile.isSet())
+    {
+      std::cerr << "usage: " << argv[0] << " [options] {file|directory}...\n"
+                   "\t-z zimfile\tuse the article data of a zim file as corpus\n"
+                   "\t-s list\t\tcomma separated minimum cluster sizes in kB (default 64,256,1024,4096)\n"
+                   "\t-c list\t\tcompressions (default all enabled of none,zlib,bzip2,lzma)\n"
+                   "\t-n number\tnumber of random blob fetches (default 1000)\n"
+                   "\t-m number\tmaximum size of the corpus in MB (default 256)\n"
+                << std::flush;
+      return 1;
+    }
+
+    std::vector<unsigned> sizes = parseList<unsigned>(sizeList);
+
+    std::vector<const Codec*> selected;
+    if (codecList.isSet())
+    {
+      std::vector<std::string> names = parseList<std::string>(codecList);
+      for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+      {
+        unsigned c = 0;
+        while (c < codecCount && *it != codecs[c].name)
+          ++c;
+        if (c == codecCount)
+          throw std::runtime_error("compression \"" + *it + "\" unknown or not enabled");
+        selected.push_back(&codecs[c]);
+      }
+    }
+    else
+    {
+      for (unsigned c = 0; c < codecCount; ++c)
+        selected.push_back(&codecs[c]);
+    }
+
+    Corpus corpus;
+    CorpusReader reader(corpus, static_cast<zim::uint64_t>(maxMBytes) * 1024 * 1024);
+    if (zimFile.isSet())
+      reader.addZimFile(zimFile);
+    for (int a = 1; a < argc; ++a)
+      reader.addPath(argv[a]);
+
+    if (corpus.empty())
+      throw std::runtime_error("corpus is empty");
+
+    std::cout << "corpus: " << corpus.size() << " blobs, " << reader.getBytes() << " bytes\n\n"
+              << "codec  size(kB) clusters  ratio  compress(MB/s)  decompress mean/p99(us)  fetch p50/p99(us)"
+              << std::endl;
+
+    for (std::vector<const Codec*>::const_iterator c = selected.begin(); c != selected.end(); ++c)
+    {
+      for (std::vector<unsigned>::const_iterator s = sizes.begin(); s != sizes.end(); ++s)
+      {
+        Result r;
+        benchmark(corpus, *s, **c, fetches, r);
+
+        double ratio = static_cast<double>(r.compressedBytes) / static_cast<double>(r.rawBytes);
+        double mbps = r.compressNsecs > 0
+                    ? static_cast<double>(r.rawBytes) / 1048576.0 / (r.compressNsecs / 1e9)
+                    : 0;
+
+        std::cout << std::left << std::setw(6) << (*c)->name << std::right
+                  << std::setw(9) << *s
+                  << std::setw(10) << r.clusters
+                  << std::fixed
+                  << std::setw(7) << std::setprecision(3) << ratio
+                  << std::setw(16) << std::setprecision(1) << mbps
+                  << std::setw(13) << std::setprecision(1) << r.decompress.getMean() / 1e3
+                  << " / " << std::setw(8) << r.decompress.getPercentile(99) / 1e3
+                  << std::setw(13) << r.fetch.getPercentile(50) / 1e3
+                  << " / " << std::setw(8) << r.fetch.getPercentile(99) / 1e3
+                  << std::endl;
+      }
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include <zim/clusterdiskcache.h>
+#include <string>
+#include <sstream>
+#include <cstdio>
+#include <fstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+
+class ClusterDiskCacheTest : public cxxtools::unit::TestSuite
+{
+    static const char* dir;
+
+    static zim::Cluster makeCluster(const std::string& blob)
+    {
+      zim::Cluster cluster;
+      cluster.setCompression(zim::zimcompZip);
+      cluster.addBlob(blob.data(), blob.size());
+      cluster.addBlob("abc", 3);
+      return cluster;
+    }
+
+    static std::string path(const zim::Uuid& uuid, zim::size_type idx)
+    {
+      std::ostringstream s;
+      s << dir << '/' << uuid << '-' << idx << ".cluster";
+      return s.str();
+    }
+
+    static bool exists(const std::string& fname)
+    {
+      struct stat st;
+      return ::stat(fname.c_str(), &st) == 0;
+    }
+
+    static void setTime(const std::string& fname, time_t t)
+    {
+      struct utimbuf times;
+      times.actime = t;
+      times.modtime = t;
+      ::utime(fname.c_str(), &times);
+    }
+
+    static void clear(const zim::Uuid& uuid, unsigned count)
+    {
+      for (unsigned n = 0; n < count; ++n)
+        std::remove(path(uuid, n).c_str());
+      ::rmdir(dir);
+    }
+
+  public:
+    ClusterDiskCacheTest()
+      : cxxtools::unit::TestSuite("zim::ClusterDiskCacheTest")
+    {
+      registerMethod("PutGet", *this, &ClusterDiskCacheTest::PutGet);
+      registerMethod("Evict", *this, &ClusterDiskCacheTest::Evict);
+      registerMethod("Invalid", *this, &ClusterDiskCacheTest::Invalid);
+    }
+
+    void PutGet()
+    {
+      zim::Uuid uuid = zim::Uuid::generate();
+      std::string blob(1000, 'x');
+
+      {
+        zim::ClusterDiskCache cache;
+        cache.open(dir, uuid, 1024 * 1024);
+        CXXTOOLS_UNIT_ASSERT(cache.enabled());
+        CXXTOOLS_UNIT_ASSERT(!cache.get(0, 100, 50));
+
+        cache.put(0, 100, 50, makeCluster(blob));
+        cache.flush();
+
+        zim::Cluster cluster = cache.get(0, 100, 50);
+        CXXTOOLS_UNIT_ASSERT(cluster);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(cluster.count(), 2);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(cluster.getCompression(), zim::zimcompZip);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(cluster.getBlobPtr(0), cluster.getBlobSize(0)), blob);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(cluster.getBlobPtr(1), cluster.getBlobSize(1)), "abc");
+      }
+
+      // the file survives the cache
+      zim::ClusterDiskCache cache;
+      cache.open(dir, uuid, 1024 * 1024);
+      CXXTOOLS_UNIT_ASSERT(cache.get(0, 100, 50));
+
+      clear(uuid, 1);
+    }
+
+    void Evict()
+    {
+      zim::Uuid uuid = zim::Uuid::generate();
+      std::string blob(1000, 'x');
+
+      zim::ClusterDiskCache cache;
+      cache.open(dir, uuid, 3500);
+
+      for (unsigned n = 0; n < 3; ++n)
+      {
+        cache.put(n, n * 100, 100, makeCluster(blob));
+        cache.flush();
+        setTime(path(uuid, n), 1000000 + n);
+      }
+
+      CXXTOOLS_UNIT_ASSERT(exists(path(uuid, 0)));
+
+      // the fourth file exceeds the limit and the oldest files are removed
+      // until 3/4 of it is reached
+      cache.put(3, 300, 100, makeCluster(blob));
+      cache.flush();
+
+      CXXTOOLS_UNIT_ASSERT(!exists(path(uuid, 0)));
+      CXXTOOLS_UNIT_ASSERT(!exists(path(uuid, 1)));
+      CXXTOOLS_UNIT_ASSERT(exists(path(uuid, 2)));
+      CXXTOOLS_UNIT_ASSERT(exists(path(uuid, 3)));
+      CXXTOOLS_UNIT_ASSERT(!cache.get(0, 0, 100));
+      CXXTOOLS_UNIT_ASSERT(cache.get(3, 300, 100));
+
+      clear(uuid, 4);
+    }
+
+    void Invalid()
+    {
+      zim::Uuid uuid = zim::Uuid::generate();
+
+      zim::ClusterDiskCache cache;
+      cache.open(dir, uuid, 1024 * 1024);
+
+      cache.put(0, 100, 50, makeCluster("hello"));
+      cache.flush();
+      CXXTOOLS_UNIT_ASSERT(cache.get(0, 100, 50));
+
+      // the cluster at another position or with another size in the zim
+      // file is not the cached one
+      CXXTOOLS_UNIT_ASSERT(!cache.get(0, 101, 50));
+      CXXTOOLS_UNIT_ASSERT(!cache.get(0, 100, 51));
+
+      // a truncated file is rejected
+      std::string fname = path(uuid, 0);
+      ::truncate(fname.c_str(), 40);
+      CXXTOOLS_UNIT_ASSERT(!cache.get(0, 100, 50));
+
+      // a file with another magic is rejected
+      {
+        std::ofstream out(fname.c_str());
+        out << "ZIMCLUS1 but not a cluster file at all";
+      }
+      CXXTOOLS_UNIT_ASSERT(!cache.get(0, 100, 50));
+
+      clear(uuid, 1);
+    }
+
+};
+
+const char* ClusterDiskCacheTest::dir = "clusterdiskcache-test.dir";
+
+cxxtools::unit::RegisterTest<ClusterDiskCacheTest> register_ClusterDiskCacheTest;
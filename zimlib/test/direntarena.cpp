@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/direntarena.h>
+#include <vector>
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+
+class DirentArenaTest : public cxxtools::unit::TestSuite
+{
+    zim::DirentArena arena;
+
+  public:
+    DirentArenaTest()
+      : cxxtools::unit::TestSuite("zim::DirentArenaTest")
+    {
+      registerMethod("GetDirent", *this, &DirentArenaTest::GetDirent);
+      registerMethod("Namespaces", *this, &DirentArenaTest::Namespaces);
+      registerMethod("FindUrl", *this, &DirentArenaTest::FindUrl);
+      registerMethod("FindTitle", *this, &DirentArenaTest::FindTitle);
+
+      // url order: A/a, A/b, A/c, I/x; title order: A/c ("Alpha"), A/a, A/b, I/x
+      zim::Dirent d;
+      d.setUrl('A', "a");
+      d.setArticle(1, 2, 3);
+      arena.add(d);
+
+      d = zim::Dirent();
+      d.setUrl('A', "b");
+      d.setRedirect(0);
+      d.setParameter("param");
+      arena.add(d);
+
+      d = zim::Dirent();
+      d.setUrl('A', "c");
+      d.setTitle("Alpha");
+      d.setArticle(1, 4, 5);
+      arena.add(d);
+
+      d = zim::Dirent();
+      d.setUrl('I', "x");
+      d.setArticle(2, 6, 0);
+      arena.add(d);
+
+      std::vector<zim::size_type> titles;
+      titles.push_back(2);
+      titles.push_back(0);
+      titles.push_back(1);
+      titles.push_back(3);
+      arena.setTitleIndex(titles);
+    }
+
+    void GetDirent()
+    {
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.size(), 4);
+
+      zim::Dirent d = arena.getDirent(0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getNamespace(), 'A');
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getUrl(), "a");
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getTitle(), "a");
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getMimeType(), 1);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getClusterNumber(), 2);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getBlobNumber(), 3);
+
+      d = arena.getDirent(1);
+      CXXTOOLS_UNIT_ASSERT(d.isRedirect());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getRedirectIndex(), 0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getParameter(), "param");
+
+      d = arena.getDirent(2);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getUrl(), "c");
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getTitle(), "Alpha");
+      CXXTOOLS_UNIT_ASSERT_EQUALS(d.getDirentSize(), 16 + 1 + 5 + 2);
+    }
+
+    void Namespaces()
+    {
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.getNamespaceBeginOffset('A'), 0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.getNamespaceEndOffset('A'), 3);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.getNamespaceBeginOffset('B'), 3);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.getNamespaceEndOffset('B'), 3);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.getNamespaceBeginOffset('I'), 3);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.getNamespaceEndOffset('I'), 4);
+    }
+
+    void FindUrl()
+    {
+      std::pair<bool, zim::size_type> r = arena.findx('A', "b");
+      CXXTOOLS_UNIT_ASSERT(r.first);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.second, 1);
+
+      r = arena.findx('I', "x");
+      CXXTOOLS_UNIT_ASSERT(r.first);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.second, 3);
+
+      r = arena.findx('A', "bb");
+      CXXTOOLS_UNIT_ASSERT(!r.first);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.second, 2);
+
+      r = arena.findx('B', "a");
+      CXXTOOLS_UNIT_ASSERT(!r.first);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.second, 4);
+    }
+
+    void FindTitle()
+    {
+      std::pair<bool, zim::size_type> r = arena.findxByTitle('A', "Alpha");
+      CXXTOOLS_UNIT_ASSERT(r.first);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(r.second, 0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.getIndexByTitle(r.second), 2);
+
+      r = arena.findxByTitle('A', "b");
+      CXXTOOLS_UNIT_ASSERT(r.first);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(arena.getIndexByTitle(r.second), 1);
+
+      r = arena.findxByTitle('A', "c");
+      CXXTOOLS_UNIT_ASSERT(!r.first);
+    }
+
+};
+
+cxxtools::unit::RegisterTest<DirentArenaTest> register_DirentArenaTest;
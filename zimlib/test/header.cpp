@@ -31,6 +31,7 @@ class FileheaderTest : public cxxtools::unit::TestSuite
       : cxxtools::unit::TestSuite("zim::FileheaderTest")
     {
       registerMethod("ReadWriteHeader", *this, &FileheaderTest::ReadWriteHeader);
+      registerMethod("ReadWriteClusterInfo", *this, &FileheaderTest::ReadWriteClusterInfo);
     }
 
     void ReadWriteHeader()
@@ -70,9 +71,38 @@ class FileheaderTest : public cxxtools::unit::TestSuite
       CXXTOOLS_UNIT_ASSERT_EQUALS(header2.getClusterPtrPos(), 45678);
       CXXTOOLS_UNIT_ASSERT_EQUALS(header2.getMainPage(), 11);
       CXXTOOLS_UNIT_ASSERT_EQUALS(header2.getLayoutPage(), 13);
+      CXXTOOLS_UNIT_ASSERT(!header2.hasClusterInfo());
 
     }
 
+    void ReadWriteClusterInfo()
+    {
+      zim::Fileheader header;
+      header.setClusterInfoPos(56789);
+
+      // without the minor version the header keeps the standard layout
+      CXXTOOLS_UNIT_ASSERT(!header.hasClusterInfo());
+      std::stringstream s0;
+      s0 << header;
+      CXXTOOLS_UNIT_ASSERT_EQUALS(s0.str().size(), zim::Fileheader::size);
+
+      header.setMinorVersion(zim::Fileheader::clusterInfoMinorVersion);
+      header.setMimeListPos(zim::Fileheader::clusterInfoSize);
+      CXXTOOLS_UNIT_ASSERT(header.hasClusterInfo());
+
+      std::stringstream s;
+      s << header;
+      CXXTOOLS_UNIT_ASSERT_EQUALS(s.str().size(), zim::Fileheader::clusterInfoSize);
+
+      zim::Fileheader header2;
+      s >> header2;
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(s.tellg(), s.tellp());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(header2.getMinorVersion(), zim::Fileheader::clusterInfoMinorVersion);
+      CXXTOOLS_UNIT_ASSERT(header2.hasClusterInfo());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(header2.getClusterInfoPos(), 56789);
+    }
+
 };
 
 cxxtools::unit::RegisterTest<FileheaderTest> register_FileheaderTest;
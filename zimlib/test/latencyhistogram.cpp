@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include <zim/latencyhistogram.h>
+#include <zim/fileobserver.h>
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+
+class LatencyHistogramTest : public cxxtools::unit::TestSuite
+{
+  public:
+    LatencyHistogramTest()
+      : cxxtools::unit::TestSuite("zim::LatencyHistogramTest")
+    {
+      registerMethod("Buckets", *this, &LatencyHistogramTest::Buckets);
+      registerMethod("Percentiles", *this, &LatencyHistogramTest::Percentiles);
+      registerMethod("Add", *this, &LatencyHistogramTest::Add);
+      registerMethod("Observer", *this, &LatencyHistogramTest::Observer);
+    }
+
+    void Buckets()
+    {
+      typedef zim::LatencyHistogram H;
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(H::bucketIndex(0), 0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(H::bucketIndex(127), 127);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(H::bucketIndex(128), 128);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(H::bucketIndex(129), 128);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(H::bucketIndex(130), 129);
+
+      // the buckets are contiguous and the relative error is small
+      for (unsigned b = 0; b + 1 < H::bucketCount; ++b)
+      {
+        CXXTOOLS_UNIT_ASSERT_EQUALS(H::bucketHigh(b) + 1, H::bucketLow(b + 1));
+        CXXTOOLS_UNIT_ASSERT_EQUALS(H::bucketIndex(H::bucketLow(b)), b);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(H::bucketIndex(H::bucketHigh(b)), b);
+        CXXTOOLS_UNIT_ASSERT(H::bucketHigh(b) - H::bucketLow(b) <= H::bucketLow(b) / 64);
+      }
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(H::bucketIndex(~static_cast<zim::uint64_t>(0)), H::bucketCount - 1);
+    }
+
+    void Percentiles()
+    {
+      zim::LatencyHistogram h;
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h.getCount(), 0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h.getPercentile(50), 0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h.getMin(), 0);
+
+      for (unsigned v = 1; v <= 100; ++v)
+        h.record(v);
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h.getCount(), 100);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h.getMin(), 1);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h.getMax(), 100);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h.getMean(), 50.5);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h.getPercentile(50), 50);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h.getPercentile(99), 99);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h.getPercentile(100), 100);
+
+      // a single slow operation shows up in the tail only
+      h.record(40000000);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h.getPercentile(99), 100);
+      zim::uint64_t p = h.getPercentile(100);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(p, 40000000);
+
+      h.clear();
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h.getCount(), 0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h.getMax(), 0);
+    }
+
+    void Add()
+    {
+      zim::LatencyHistogram h1;
+      zim::LatencyHistogram h2;
+      h1.record(10);
+      h2.record(1000);
+      h2.record(5);
+
+      h1.add(h2);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h1.getCount(), 3);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h1.getMin(), 5);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h1.getMax(), 1000);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(h1.getPercentile(50), 10);
+    }
+
+    void Observer()
+    {
+      zim::HistogramObserver observer;
+      {
+        zim::OperationTimer timer(&observer, zim::operationGetCluster, 7);
+      }
+      {
+        zim::OperationTimer timer(0, zim::operationGetCluster, 7);
+      }
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(observer.getHistogram(zim::operationGetCluster).getCount(), 1);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(observer.getHistogram(zim::operationGetDirent).getCount(), 0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(zim::getOperationName(zim::operationFindUrl)), "findUrl");
+    }
+
+};
+
+cxxtools::unit::RegisterTest<LatencyHistogramTest> register_LatencyHistogramTest;
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include <zim/urlindex.h>
+#include <cstdio>
+
+#include <cxxtools/unit/testsuite.h>
+#include <cxxtools/unit/registertest.h>
+
+class UrlIndexTest : public cxxtools::unit::TestSuite
+{
+    static zim::size_type find(const zim::UrlIndex& index, zim::uint64_t h)
+    {
+      unsigned probe = 0;
+      return index.lookup(h, probe);
+    }
+
+  public:
+    UrlIndexTest()
+      : cxxtools::unit::TestSuite("zim::UrlIndexTest")
+    {
+      registerMethod("Lookup", *this, &UrlIndexTest::Lookup);
+      registerMethod("Collision", *this, &UrlIndexTest::Collision);
+      registerMethod("ReadWrite", *this, &UrlIndexTest::ReadWrite);
+      registerMethod("Damaged", *this, &UrlIndexTest::Damaged);
+    }
+
+    void Lookup()
+    {
+      zim::UrlIndex index;
+      CXXTOOLS_UNIT_ASSERT(index.empty());
+
+      index.init(3);
+      index.insert(zim::UrlIndex::hash('A', "a"), 0);
+      index.insert(zim::UrlIndex::hash('A', "b"), 1);
+      index.insert(zim::UrlIndex::hash('I', "a"), 2);
+
+      CXXTOOLS_UNIT_ASSERT(!index.empty());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(find(index, zim::UrlIndex::hash('A', "a")), 0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(find(index, zim::UrlIndex::hash('A', "b")), 1);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(find(index, zim::UrlIndex::hash('I', "a")), 2);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(find(index, zim::UrlIndex::hash('A', "c")), zim::UrlIndex::npos);
+    }
+
+    void Collision()
+    {
+      zim::UrlIndex index;
+      index.init(2);
+      index.insert(42, 5);
+      index.insert(42, 7);
+
+      unsigned probe = 0;
+      CXXTOOLS_UNIT_ASSERT_EQUALS(index.lookup(42, probe), 5);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(index.lookup(42, probe), 7);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(index.lookup(42, probe), zim::UrlIndex::npos);
+    }
+
+    void ReadWrite()
+    {
+      const char* fname = "urlindex-test.urlidx";
+
+      zim::Uuid uuid = zim::Uuid::generate();
+      zim::UrlIndex index;
+      index.init(2);
+      index.insert(zim::UrlIndex::hash('A', "a"), 0);
+      index.insert(zim::UrlIndex::hash('A', "b"), 1);
+      index.write(fname, uuid, 2);
+
+      zim::UrlIndex index2;
+      CXXTOOLS_UNIT_ASSERT(index2.read(fname, uuid, 2));
+      CXXTOOLS_UNIT_ASSERT_EQUALS(find(index2, zim::UrlIndex::hash('A', "a")), 0);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(find(index2, zim::UrlIndex::hash('A', "b")), 1);
+
+      // the index must match the zim file
+      zim::UrlIndex index3;
+      CXXTOOLS_UNIT_ASSERT(!index3.read(fname, zim::Uuid::generate(), 2));
+      CXXTOOLS_UNIT_ASSERT(!index3.read(fname, uuid, 3));
+      CXXTOOLS_UNIT_ASSERT(index3.empty());
+
+      std::remove(fname);
+    }
+
+    void Damaged()
+    {
+      const char* fname = "urlindex-test.urlidx";
+
+      // an article index beyond the article count is not accepted
+      zim::Uuid uuid = zim::Uuid::generate();
+      zim::UrlIndex index;
+      index.init(2);
+      index.insert(zim::UrlIndex::hash('A', "a"), 0);
+      index.insert(zim::UrlIndex::hash('A', "b"), 5);
+      index.write(fname, uuid, 2);
+
+      zim::UrlIndex index2;
+      CXXTOOLS_UNIT_ASSERT(!index2.read(fname, uuid, 2));
+      CXXTOOLS_UNIT_ASSERT(index2.empty());
+
+      std::remove(fname);
+    }
+
+};
+
+cxxtools::unit::RegisterTest<UrlIndexTest> register_UrlIndexTest;
@@ -24,6 +24,7 @@
 #include <zim/file.h>
 #include <zim/fileiterator.h>
 #include <stdexcept>
+#include <algorithm>
 #include <iostream>
 #include <cxxtools/log.h>
 
@@ -73,7 +74,9 @@ namespace zim
 
       size_type count = 0;
       size_type progress = 0;
-      for (zim::File::const_iterator it = zimfile.begin(); it != zimfile.end(); ++it, ++count)
+      // the articles are processed in cluster order, so that each cluster is
+      // uncompressed just once; the entries are sorted by article in fetchData
+      for (zim::File::const_iterator it = zimfile.beginByCluster(); it != zimfile.end(); ++it, ++count)
       {
         zim::Article article = *it;
 
@@ -114,6 +117,14 @@ namespace zim
       _currentStream = _mstream.end();
     }
 
+    namespace
+    {
+      bool compareIndex(const IndexEntry& e1, const IndexEntry& e2)
+      {
+        return e1.getIndex() < e2.getIndex();
+      }
+    }
+
     void Indexer::fetchData(const std::string& aid)
     {
       log_trace("fetch data for aid \"" << aid << '"');
@@ -137,6 +148,11 @@ namespace zim
         currentData[w.weight].push_back(IndexEntry(w.aid, w.pos));
       }
 
+      // the articles are not processed in index order, but the entries are
+      // delta encoded
+      for (unsigned c = 0; c < 4; ++c)
+        std::stable_sort(currentData[c].begin(), currentData[c].end(), compareIndex);
+
       log_debug("create int-compressed data");
 
       std::ostringstream zdata[4];